@@ -0,0 +1,239 @@
+#pragma once
+
+#include "MatchingEngine.hpp"
+#include "SessionFile.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <vector>
+
+namespace hft {
+
+struct StrategyFill {
+    double                   price;
+    int64_t                  quantity;
+    bool                     is_buy;
+    std::chrono::nanoseconds timestamp;
+};
+
+// What a strategy sees of its own backtest task: order entry against the
+// replayed book plus its running position and cash
+class BacktestContext {
+public:
+    using Engine = MatchingEngine<double, int64_t, uint64_t>;
+
+    explicit BacktestContext(Engine& engine);
+
+    // Immediate-or-cancel against the replayed top of book. Fills are capped
+    // at the size of the opposite tape quote, which the fill then consumes
+    // until the tape replaces it. Returns true if the order traded; the fill
+    // is also delivered to on_fill if the strategy has one.
+    bool submit(double price, int64_t quantity, bool is_buy);
+
+    int64_t                  position() const { return position_; }
+    double                   cash() const { return cash_; }
+    double                   last_price() const { return last_price_; }
+    std::chrono::nanoseconds now() const { return now_; }
+
+private:
+    template<typename S>
+    friend class Backtester;
+
+    static constexpr uint64_t kStrategyIdBit = uint64_t{1} << 63;
+
+    // The tape is replayed as one resting quote per side that each update replaces
+    struct TapeQuote {
+        uint64_t id       = 0;
+        double   price    = 0.0;
+        int64_t  quantity = 0;
+    };
+
+    void on_engine_fill(uint64_t id, double price, int64_t quantity);
+    void on_tape_update(const RecordedUpdate& update);
+    void rest(TapeQuote& quote, bool is_buy);
+
+    Engine&                   engine_;
+    TapeQuote                 tape_bid_;
+    TapeQuote                 tape_ask_;
+    uint64_t                  next_tape_id_     = 1;
+    std::vector<StrategyFill> pending_fills_;
+    uint64_t                  next_strategy_id_ = kStrategyIdBit;
+    bool                      pending_is_buy_   = false;
+
+    int64_t                  position_   = 0;
+    double                   cash_       = 0.0;
+    double                   last_price_ = 0.0;
+    std::chrono::nanoseconds now_{0};
+
+    uint64_t orders_ = 0;
+    uint64_t fills_  = 0;
+    int64_t  volume_ = 0;
+};
+
+template<typename S>
+concept BacktestStrategy = requires(S strategy, const RecordedUpdate& update, BacktestContext& context) {
+    { strategy.on_market_update(update, context) };
+};
+
+// One recorded (day, symbol) pair: <root>/<day>/<symbol>.bin
+struct SessionTask {
+    std::string           day;
+    std::string           symbol;
+    std::filesystem::path path;
+    uintmax_t             size;
+};
+
+// Sorted by day then symbol
+std::vector<SessionTask> discover_sessions(const std::filesystem::path& root);
+
+struct BacktestResult {
+    std::string day;
+    std::string symbol;
+    uint64_t    updates    = 0;
+    uint64_t    orders     = 0;
+    uint64_t    fills      = 0;
+    int64_t     volume     = 0;
+    int64_t     position   = 0;
+    double      cash       = 0.0;
+    double      last_price = 0.0;
+    double      seconds    = 0.0;
+
+    // Marked to the last replayed price
+    double pnl() const { return cash + static_cast<double>(position) * last_price; }
+};
+
+struct BacktestSummary {
+    std::vector<BacktestResult> sessions;  // In discover_sessions order
+    uint64_t                    updates      = 0;
+    uint64_t                    orders       = 0;
+    uint64_t                    fills        = 0;
+    int64_t                     volume       = 0;
+    double                      pnl          = 0.0;
+    double                      wall_seconds = 0.0;
+};
+
+struct BacktestConfig {
+    std::filesystem::path root;
+    int                   threads = 0;  // 0 uses every core
+};
+
+// Replays every recorded session through its own MatchingEngine and
+// strategy instance on a TBB task arena. Tasks share nothing mutable:
+// each writes only its own result slot, and slots are merged after the
+// parallel loop. Workers claim sessions largest first from a shared
+// cursor, so the longest replays start early and the tail stays short.
+template<typename S>
+class Backtester {
+public:
+    using StrategyFactory = std::function<S(const SessionTask&)>;
+
+    Backtester(BacktestConfig config, StrategyFactory factory)
+        : config_(std::move(config)), factory_(std::move(factory)) {}
+
+    BacktestSummary run() const;
+
+    // Runs one session on the calling thread
+    BacktestResult run_session(const SessionTask& task) const;
+
+private:
+    BacktestConfig  config_;
+    StrategyFactory factory_;
+};
+
+template<typename S>
+BacktestSummary Backtester<S>::run() const {
+    static_assert(BacktestStrategy<S>, "Strategy must provide on_market_update(const RecordedUpdate&, BacktestContext&)");
+
+    auto start = std::chrono::steady_clock::now();
+
+    BacktestSummary summary;
+    std::vector<SessionTask> tasks = discover_sessions(config_.root);
+    summary.sessions.resize(tasks.size());
+
+    std::vector<size_t> schedule(tasks.size());
+    for (size_t i = 0; i < schedule.size(); ++i) {
+        schedule[i] = i;
+    }
+    std::stable_sort(schedule.begin(), schedule.end(),
+                     [&](size_t a, size_t b) { return tasks[a].size > tasks[b].size; });
+
+    // parallel_for hands out ranges in whatever order its partitioner likes,
+    // so it only spawns one claimer per arena slot and the claimers walk the
+    // sorted schedule through an atomic cursor
+    tbb::task_arena     arena(config_.threads > 0 ? config_.threads : tbb::task_arena::automatic);
+    std::atomic<size_t> next{0};
+    arena.execute([&] {
+        tbb::parallel_for(0, arena.max_concurrency(), [&](int) {
+            for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < schedule.size();
+                 i = next.fetch_add(1, std::memory_order_relaxed)) {
+                size_t task = schedule[i];
+                summary.sessions[task] = run_session(tasks[task]);
+            }
+        });
+    });
+
+    for (const BacktestResult& result : summary.sessions) {
+        summary.updates += result.updates;
+        summary.orders += result.orders;
+        summary.fills += result.fills;
+        summary.volume += result.volume;
+        summary.pnl += result.pnl();
+    }
+    summary.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return summary;
+}
+
+template<typename S>
+BacktestResult Backtester<S>::run_session(const SessionTask& task) const {
+    auto start = std::chrono::steady_clock::now();
+
+    SessionReader           reader(task.path);
+    BacktestContext::Engine engine;
+    BacktestContext         context(engine);
+    S                       strategy = factory_(task);
+
+    engine.set_fill_callback([&context](const uint64_t& id, double price, int64_t quantity) {
+        context.on_engine_fill(id, price, quantity);
+    });
+
+    for (const RecordedUpdate& update : reader.updates()) {
+        context.now_ = update.timestamp;
+        context.on_tape_update(update);
+        context.last_price_ = update.price;
+        strategy.on_market_update(update, context);
+
+        if constexpr (requires(const StrategyFill& fill) { strategy.on_fill(fill, context); }) {
+            // Fills can trigger more orders; swap out so those land in a fresh batch
+            while (!context.pending_fills_.empty()) {
+                std::vector<StrategyFill> fills;
+                fills.swap(context.pending_fills_);
+                for (const StrategyFill& fill : fills) {
+                    strategy.on_fill(fill, context);
+                }
+            }
+        } else {
+            context.pending_fills_.clear();
+        }
+    }
+
+    BacktestResult result;
+    result.day        = task.day;
+    result.symbol     = task.symbol;
+    result.updates    = reader.updates().size();
+    result.orders     = context.orders_;
+    result.fills      = context.fills_;
+    result.volume     = context.volume_;
+    result.position   = context.position_;
+    result.cash       = context.cash_;
+    result.last_price = context.last_price_;
+    result.seconds    = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+} // namespace hft
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace hft::columnar {
+
+// Integer column codec used by the columnar tick store.
+//
+// A column is a two-word header (encoding and bit width, then a base value)
+// followed by bit-packed 64-bit words. Values are packed in groups of
+// kGroupSize spread across kLanes interleaved lanes: value i lives in lane
+// i % kLanes, and word j of every lane is stored side by side. Every lane
+// therefore needs the same shift at the same step, which is what lets the
+// unpack kernel run one 256-bit vector per step instead of one value.
+
+inline constexpr size_t kLanes     = 4;
+inline constexpr size_t kGroupSize = 64 * kLanes;
+
+enum class ColumnEncoding : uint8_t {
+    Delta            = 1,  // base = first value, packs zig-zag(v[i] - v[i-1])
+    FrameOfReference = 2,  // base = minimum, packs v[i] - base
+};
+
+// Number of values a decode buffer must hold for `count` values
+inline constexpr size_t padded_count(size_t count) {
+    return (count + kGroupSize - 1) / kGroupSize * kGroupSize;
+}
+
+// Words an encoded column of `count` values at `width` bits occupies, header included
+inline constexpr size_t encoded_words(size_t count, unsigned width) {
+    return 2 + padded_count(count) / kGroupSize * kLanes * width;
+}
+
+// Appends the encoded column to out
+void encode_column(ColumnEncoding encoding, const int64_t* values, size_t count, std::vector<uint64_t>& out);
+
+// Decodes `count` values into out, which must hold padded_count(count).
+// Returns the word just past the column.
+const uint64_t* decode_column(const uint64_t* in, size_t count, int64_t* out);
+
+// Skips a column without decoding it
+const uint64_t* skip_column(const uint64_t* in, size_t count);
+
+// Raw group kernels, exposed for tests and benchmarks. `groups` groups of
+// kGroupSize values at `width` bits (0-64).
+void pack(const uint64_t* in, size_t groups, unsigned width, uint64_t* out);
+void unpack(const uint64_t* in, size_t groups, unsigned width, uint64_t* out);
+
+} // namespace hft::columnar
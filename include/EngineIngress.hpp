@@ -0,0 +1,538 @@
+#pragma once
+
+#include "MatchingEngine.hpp"
+#include "SpscRing.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace hft {
+
+enum class OverloadPolicy : uint8_t {
+    RejectNew,  // While overloaded, refuse new orders from sources above their fair share
+    ShedStale,  // Keep queueing; drop new orders that waited longer than max_queue_delay
+};
+
+enum class Admission : uint8_t {
+    Accepted,
+    RejectedFull,      // The source's own queue is at capacity
+    RejectedOverload,  // Refused by the overload policy
+    RejectedStopped,   // Submitted after stop(), when no worker will drain it
+};
+
+struct IngressConfig {
+    size_t                   queue_capacity   = 1024;  // Per source and per queue, power of two
+    size_t                   max_sources      = 64;
+    size_t                   high_watermark   = 4096;  // Queued orders and cancels that start overload
+    size_t                   low_watermark    = 1024;  // ... and that end it
+    OverloadPolicy           policy           = OverloadPolicy::RejectNew;
+    std::chrono::nanoseconds max_queue_delay  = std::chrono::milliseconds(1);  // ShedStale only
+    bool                     cancels_first    = true;  // Drain every cancel queue before any new order
+    size_t                   batch_per_source = 16;    // Round-robin quantum
+    int                      cpu              = -1;    // Pin the worker when >= 0
+};
+
+// Engine-wide totals. Apart from overload_episodes every counter has a
+// single writer, so they are plain relaxed stores rather than
+// read-modify-write atomics.
+struct IngressStats {
+    uint64_t depth;              // Orders and cancels queued at the end of the last poll
+    uint64_t peak_depth;         // Highest depth seen at the start of a poll, before draining
+    uint64_t admitted;
+    uint64_t rejected_full;
+    uint64_t rejected_overload;
+    uint64_t shed;
+    uint64_t withdrawn;  // Cancelled while still queued
+    uint64_t executed;
+    uint64_t cancels;
+    uint64_t overload_episodes;
+    uint64_t total_queue_delay_ns;
+    uint64_t max_queue_delay_ns;
+    bool     overloaded;
+};
+
+struct SourceStats {
+    uint64_t depth;
+    uint64_t admitted;
+    uint64_t rejected_full;
+    uint64_t rejected_overload;
+    uint64_t shed;
+    uint64_t withdrawn;
+    uint64_t executed;
+};
+
+// Admission control in front of a MatchingEngine. Each source (a session,
+// a strategy thread) gets its own bounded SPSC queues for new orders and
+// cancels, so one flooding source only ever fills its own queues. A single
+// worker drains the sources round robin, at most batch_per_source orders
+// each per round, and is the only caller into the engine.
+//
+// Overload is judged on total depth with hysteresis between the two
+// watermarks. Cancels are never refused for overload: they shrink the book
+// and the backlog, and run ahead of new orders when cancels_first is set.
+template<Price P, Quantity Q, OrderId ID>
+class EngineIngress {
+public:
+    using Engine   = MatchingEngine<P, Q, ID>;
+    using Order    = typename OrderBook<P, Q, ID>::Order;
+    using SourceId = uint32_t;
+
+    EngineIngress(Engine& engine, IngressConfig config = {});
+    ~EngineIngress() { stop(); }
+
+    EngineIngress(const EngineIngress&)            = delete;
+    EngineIngress& operator=(const EngineIngress&) = delete;
+
+    // Each source must be fed by one thread at a time
+    SourceId add_source();
+
+    // Refused with RejectedStopped once stop() has been called, until the
+    // next start()
+    Admission submit(SourceId source, const Order& order);
+    Admission cancel(SourceId source, const ID& order_id);
+
+    void start();
+    void stop();  // Drains everything admitted before returning
+
+    // One round over every source on the calling thread, for driving the
+    // ingress by hand without start(). The queues have a single consumer, so
+    // this throws std::logic_error while the worker is running. Returns the
+    // number of orders and cancels taken off queues.
+    size_t poll();
+
+    IngressStats stats() const;
+    SourceStats  source_stats(SourceId source) const;
+
+    // Upper bound of the bucket holding the q-th quantile of queueing
+    // delay for executed orders; buckets are powers of two nanoseconds
+    std::chrono::nanoseconds queue_delay_quantile(double q) const;
+
+private:
+    struct QueuedOrder {
+        Order   order;
+        int64_t enqueued_ns;
+    };
+
+    struct QueuedCancel {
+        ID      order_id;
+        int64_t enqueued_ns;
+    };
+
+    struct Source {
+        explicit Source(size_t capacity) : orders(capacity), cancels(capacity) {}
+
+        SpscRing<QueuedOrder>  orders;
+        SpscRing<QueuedCancel> cancels;
+
+        // Producer-written
+        alignas(64) std::atomic<bool> submitting{false};  // Between the stopped_ check and the push
+        std::atomic<uint64_t> admitted{0};
+        std::atomic<uint64_t> rejected_full{0};
+        std::atomic<uint64_t> rejected_overload{0};
+
+        // Worker-written
+        alignas(64) std::atomic<uint64_t> shed{0};
+        std::atomic<uint64_t> withdrawn{0};
+        std::atomic<uint64_t> executed{0};
+        std::unordered_set<ID> early_cancels;  // Cancels that overtook their order
+    };
+
+    static constexpr size_t kDelayBuckets = 65;
+
+    // Queueing delay compares stamps taken on different threads, so it needs
+    // a clock that is monotonic across them; thread_time() is wall clock
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t by = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + by, std::memory_order_relaxed);
+    }
+
+    bool   enter_submit(Source& source);
+    size_t drain();
+    size_t drain_cancels(Source& source, size_t limit);
+    size_t drain_orders(Source& source, size_t limit);
+    size_t queued() const;
+    size_t committed() const;
+    void   enter_overload();
+    void   update_peak(size_t depth);
+    void   update_depth();
+    void   run();
+
+    Engine&       engine_;
+    IngressConfig config_;
+
+    std::mutex                           sources_mutex_;  // add_source only
+    std::vector<std::unique_ptr<Source>> sources_;        // Sized once, filled by add_source
+    std::atomic<size_t>                  source_count_{0};
+
+    // Raised by whoever sees the high watermark, cleared by the worker
+    alignas(64) std::atomic<bool> overloaded_{false};
+    std::atomic<size_t> fair_share_{0};
+
+    // Worker-written telemetry
+    alignas(64) std::atomic<uint64_t> depth_{0};
+    std::atomic<uint64_t>                            peak_depth_{0};
+    std::atomic<uint64_t>                            cancels_{0};
+    std::atomic<uint64_t>                            overload_episodes_{0};  // Producers may raise overload too
+    std::atomic<uint64_t>                            total_delay_ns_{0};
+    std::atomic<uint64_t>                            max_delay_ns_{0};
+    std::array<std::atomic<uint64_t>, kDelayBuckets> delay_buckets_{};
+    size_t                                           next_source_ = 0;
+
+    std::atomic<bool> running_{false};
+    std::atomic<bool> worker_active_{false};  // From start() until stop() has joined the worker
+    std::atomic<bool> stopped_{false};
+    std::thread       worker_;
+};
+
+template<Price P, Quantity Q, OrderId ID>
+EngineIngress<P, Q, ID>::EngineIngress(Engine& engine, IngressConfig config)
+    : engine_(engine), config_(config) {
+    if (config_.max_sources == 0 || config_.batch_per_source == 0 ||
+        config_.low_watermark > config_.high_watermark) {
+        throw std::invalid_argument("Invalid ingress configuration");
+    }
+    sources_.resize(config_.max_sources);
+}
+
+template<Price P, Quantity Q, OrderId ID>
+typename EngineIngress<P, Q, ID>::SourceId EngineIngress<P, Q, ID>::add_source() {
+    std::lock_guard<std::mutex> lock(sources_mutex_);
+    size_t id = source_count_.load(std::memory_order_relaxed);
+    if (id == sources_.size()) {
+        throw std::runtime_error("Too many ingress sources");
+    }
+    sources_[id] = std::make_unique<Source>(config_.queue_capacity);
+    fair_share_.store(std::max<size_t>(1, config_.high_watermark / (id + 1)), std::memory_order_relaxed);
+    source_count_.store(id + 1, std::memory_order_release);
+    return static_cast<SourceId>(id);
+}
+
+// Producers flag themselves before checking stopped_ and stop() raises
+// stopped_ before waiting for the flags to clear; both sides are seq_cst, so
+// either the producer sees the stop or stop() sees its push and drains it.
+template<Price P, Quantity Q, OrderId ID>
+bool EngineIngress<P, Q, ID>::enter_submit(Source& source) {
+    source.submitting.store(true);
+    if (unlikely(stopped_.load())) {
+        source.submitting.store(false, std::memory_order_release);
+        return false;
+    }
+    return true;
+}
+
+template<Price P, Quantity Q, OrderId ID>
+Admission EngineIngress<P, Q, ID>::submit(SourceId id, const Order& order) {
+    Source& source = *sources_[id];
+    if (!enter_submit(source)) {
+        return Admission::RejectedStopped;
+    }
+    Admission admission = Admission::Accepted;
+    if (config_.policy == OverloadPolicy::RejectNew &&
+        source.orders.size() >= fair_share_.load(std::memory_order_relaxed)) {
+        // Only sources past their share pay for the full depth sum, and they
+        // don't wait for the worker's next poll to notice the watermark
+        if (overloaded_.load(std::memory_order_relaxed) || committed() >= config_.high_watermark) {
+            enter_overload();
+            bump(source.rejected_overload);
+            admission = Admission::RejectedOverload;
+        }
+    }
+    if (admission == Admission::Accepted) {
+        if (source.orders.try_push({order, now_ns()})) {
+            bump(source.admitted);
+        } else {
+            bump(source.rejected_full);
+            admission = Admission::RejectedFull;
+        }
+    }
+    source.submitting.store(false, std::memory_order_release);
+    return admission;
+}
+
+template<Price P, Quantity Q, OrderId ID>
+Admission EngineIngress<P, Q, ID>::cancel(SourceId id, const ID& order_id) {
+    Source& source = *sources_[id];
+    if (!enter_submit(source)) {
+        return Admission::RejectedStopped;
+    }
+    Admission admission = Admission::Accepted;
+    if (!source.cancels.try_push({order_id, now_ns()})) {
+        bump(source.rejected_full);
+        admission = Admission::RejectedFull;
+    }
+    source.submitting.store(false, std::memory_order_release);
+    return admission;
+}
+
+template<Price P, Quantity Q, OrderId ID>
+void EngineIngress<P, Q, ID>::start() {
+    if (running_) {
+        return;
+    }
+    stopped_       = false;
+    worker_active_ = true;
+    running_       = true;
+    worker_        = std::thread([this]() { run(); });
+}
+
+template<Price P, Quantity Q, OrderId ID>
+void EngineIngress<P, Q, ID>::stop() {
+    stopped_ = true;
+    running_ = false;
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+
+    // A submit that passed its stopped_ check before the store above may
+    // have pushed after the worker's last round; wait it out and drain here
+    size_t count = source_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        while (sources_[i]->submitting.load()) {
+            std::this_thread::yield();
+        }
+    }
+    while (drain() > 0) {
+    }
+    worker_active_ = false;
+}
+
+template<Price P, Quantity Q, OrderId ID>
+void EngineIngress<P, Q, ID>::run() {
+    if (config_.cpu >= 0) {
+        utils::pin_current_thread(config_.cpu);
+    }
+    while (true) {
+        // Read running_ before draining so nothing admitted before stop() is lost
+        bool keep_running = running_.load(std::memory_order_acquire);
+        if (drain() == 0) {
+            if (!keep_running) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+}
+
+template<Price P, Quantity Q, OrderId ID>
+size_t EngineIngress<P, Q, ID>::poll() {
+    if (worker_active_.load(std::memory_order_acquire)) {
+        throw std::logic_error("EngineIngress::poll() called while the worker is running");
+    }
+    return drain();
+}
+
+template<Price P, Quantity Q, OrderId ID>
+size_t EngineIngress<P, Q, ID>::drain() {
+    size_t count = source_count_.load(std::memory_order_acquire);
+    if (count == 0) {
+        return 0;
+    }
+    // Sample before draining: producers fill the queues between rounds, so
+    // this is where depth peaks
+    update_peak(queued());
+
+    size_t taken = 0;
+    if (config_.cancels_first) {
+        for (size_t i = 0; i < count; ++i) {
+            taken += drain_cancels(*sources_[i], config_.queue_capacity);
+        }
+    }
+
+    // Rotate the starting source so nobody is always served first
+    for (size_t n = 0; n < count; ++n) {
+        Source& source = *sources_[(next_source_ + n) % count];
+        if (!config_.cancels_first) {
+            taken += drain_cancels(source, config_.batch_per_source);
+        }
+        taken += drain_orders(source, config_.batch_per_source);
+    }
+    next_source_ = (next_source_ + 1) % count;
+
+    update_depth();
+    return taken;
+}
+
+template<Price P, Quantity Q, OrderId ID>
+size_t EngineIngress<P, Q, ID>::drain_cancels(Source& source, size_t limit) {
+    QueuedCancel cancel;
+    size_t       taken = 0;
+    while (taken < limit && source.cancels.try_pop(cancel)) {
+        ++taken;
+        bump(cancels_);
+        try {
+            engine_.cancel_order(cancel.order_id);
+        } catch (const std::runtime_error&) {
+            // Either unknown, or its order is still queued behind the cancel
+            if (!source.orders.empty()) {
+                source.early_cancels.insert(cancel.order_id);
+            }
+        }
+    }
+    return taken;
+}
+
+template<Price P, Quantity Q, OrderId ID>
+size_t EngineIngress<P, Q, ID>::drain_orders(Source& source, size_t limit) {
+    QueuedOrder queued;
+    size_t      taken = 0;
+    while (taken < limit && source.orders.try_pop(queued)) {
+        ++taken;
+        if (unlikely(!source.early_cancels.empty()) && source.early_cancels.erase(queued.order.id) > 0) {
+            bump(source.withdrawn);
+            continue;
+        }
+
+        // Read per order: a round can take many service times, and each one
+        // adds to the wait of every order still behind it
+        uint64_t delay = static_cast<uint64_t>(std::max<int64_t>(0, now_ns() - queued.enqueued_ns));
+        if (config_.policy == OverloadPolicy::ShedStale &&
+            delay > static_cast<uint64_t>(config_.max_queue_delay.count())) {
+            bump(source.shed);
+            continue;
+        }
+
+        engine_.handle_order(queued.order);
+        bump(source.executed);
+        bump(total_delay_ns_, delay);
+        bump(delay_buckets_[std::bit_width(delay)]);
+        if (delay > max_delay_ns_.load(std::memory_order_relaxed)) {
+            max_delay_ns_.store(delay, std::memory_order_relaxed);
+        }
+    }
+    if (source.orders.empty()) {
+        // Every order enqueued before those cancels has now been seen
+        source.early_cancels.clear();
+    }
+    return taken;
+}
+
+template<Price P, Quantity Q, OrderId ID>
+void EngineIngress<P, Q, ID>::update_peak(size_t depth) {
+    if (depth > peak_depth_.load(std::memory_order_relaxed)) {
+        peak_depth_.store(depth, std::memory_order_relaxed);
+    }
+}
+
+template<Price P, Quantity Q, OrderId ID>
+void EngineIngress<P, Q, ID>::update_depth() {
+    size_t depth = queued();
+    depth_.store(depth, std::memory_order_relaxed);
+    update_peak(depth);
+
+    bool overloaded = overloaded_.load(std::memory_order_relaxed);
+    if (!overloaded && depth >= config_.high_watermark) {
+        enter_overload();
+    } else if (overloaded && depth <= config_.low_watermark) {
+        overloaded_.store(false, std::memory_order_relaxed);
+    }
+}
+
+template<Price P, Quantity Q, OrderId ID>
+size_t EngineIngress<P, Q, ID>::queued() const {
+    size_t count = source_count_.load(std::memory_order_acquire);
+    size_t depth = 0;
+    for (size_t i = 0; i < count; ++i) {
+        depth += sources_[i]->orders.size() + sources_[i]->cancels.size();
+    }
+    return depth;
+}
+
+// Like queued(), but every source counts as holding at least its fair share.
+// Sources under their share are always admitted, so the room they may still
+// claim is kept back from the ones over it and depth stays near the watermark.
+template<Price P, Quantity Q, OrderId ID>
+size_t EngineIngress<P, Q, ID>::committed() const {
+    size_t count = source_count_.load(std::memory_order_acquire);
+    size_t share = fair_share_.load(std::memory_order_relaxed);
+    size_t depth = 0;
+    for (size_t i = 0; i < count; ++i) {
+        depth += std::max(sources_[i]->orders.size(), share) + sources_[i]->cancels.size();
+    }
+    return depth;
+}
+
+template<Price P, Quantity Q, OrderId ID>
+void EngineIngress<P, Q, ID>::enter_overload() {
+    if (!overloaded_.load(std::memory_order_relaxed) && !overloaded_.exchange(true, std::memory_order_relaxed)) {
+        overload_episodes_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template<Price P, Quantity Q, OrderId ID>
+IngressStats EngineIngress<P, Q, ID>::stats() const {
+    IngressStats stats{};
+    stats.depth                = depth_.load(std::memory_order_relaxed);
+    stats.peak_depth           = peak_depth_.load(std::memory_order_relaxed);
+    stats.cancels              = cancels_.load(std::memory_order_relaxed);
+    stats.overload_episodes    = overload_episodes_.load(std::memory_order_relaxed);
+    stats.total_queue_delay_ns = total_delay_ns_.load(std::memory_order_relaxed);
+    stats.max_queue_delay_ns   = max_delay_ns_.load(std::memory_order_relaxed);
+    stats.overloaded           = overloaded_.load(std::memory_order_relaxed);
+
+    size_t count = source_count_.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; ++i) {
+        SourceStats source = source_stats(static_cast<SourceId>(i));
+        stats.admitted += source.admitted;
+        stats.rejected_full += source.rejected_full;
+        stats.rejected_overload += source.rejected_overload;
+        stats.shed += source.shed;
+        stats.withdrawn += source.withdrawn;
+        stats.executed += source.executed;
+    }
+    return stats;
+}
+
+template<Price P, Quantity Q, OrderId ID>
+SourceStats EngineIngress<P, Q, ID>::source_stats(SourceId id) const {
+    const Source& source = *sources_[id];
+    return {
+        source.orders.size() + source.cancels.size(),
+        source.admitted.load(std::memory_order_relaxed),
+        source.rejected_full.load(std::memory_order_relaxed),
+        source.rejected_overload.load(std::memory_order_relaxed),
+        source.shed.load(std::memory_order_relaxed),
+        source.withdrawn.load(std::memory_order_relaxed),
+        source.executed.load(std::memory_order_relaxed),
+    };
+}
+
+template<Price P, Quantity Q, OrderId ID>
+std::chrono::nanoseconds EngineIngress<P, Q, ID>::queue_delay_quantile(double q) const {
+    std::array<uint64_t, kDelayBuckets> counts;
+    uint64_t                            total = 0;
+    for (size_t b = 0; b < kDelayBuckets; ++b) {
+        counts[b] = delay_buckets_[b].load(std::memory_order_relaxed);
+        total += counts[b];
+    }
+    if (total == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t b = 0; b < kDelayBuckets; ++b) {
+        seen += counts[b];
+        if (seen >= rank) {
+            uint64_t bound = b >= 63 ? std::numeric_limits<int64_t>::max() : (uint64_t{1} << b) - 1;
+            return std::chrono::nanoseconds(static_cast<int64_t>(bound));
+        }
+    }
+    return std::chrono::nanoseconds(std::numeric_limits<int64_t>::max());
+}
+
+} // namespace hft
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace hft::feed {
+
+// Binary incremental market data feed published by MarketDataPublisher.
+// Every UDP datagram is a PacketHeader followed by message_count messages.
+// Each message consumes one sequence number; a packet's header carries the
+// sequence of its first message so receivers can detect gaps per datagram.
+// Prices are integer ticks (see protocol::kPriceScale), little-endian host order.
+
+enum class MessageType : uint8_t {
+    LevelAdd      = 1,
+    LevelModify   = 2,
+    LevelDelete   = 3,
+    Trade         = 4,
+    SnapshotBegin = 5,  // Receivers clear their book...
+    SnapshotLevel = 6,  // ...rebuild it from these...
+    SnapshotEnd   = 7,  // ...and resume applying increments
+};
+
+#pragma pack(push, 1)
+
+struct PacketHeader {
+    uint64_t sequence;  // Sequence number of the first message in the packet
+    uint16_t message_count;
+    uint16_t length;    // Whole datagram, header included
+    uint32_t reserved;
+    uint64_t send_time;  // Publisher clock, nanoseconds
+};
+
+struct MessageHeader {
+    uint16_t    length;
+    MessageType type;
+    uint8_t     is_buy;  // Book side for levels, aggressor side for trades
+};
+
+// LevelAdd / LevelModify / LevelDelete / SnapshotLevel. Quantity is the
+// level's new total, zero on delete.
+struct LevelUpdate {
+    MessageHeader header;
+    int64_t       price;
+    int64_t       quantity;
+};
+
+struct Trade {
+    MessageHeader header;
+    int64_t       price;
+    int64_t       quantity;
+};
+
+struct SnapshotBegin {
+    MessageHeader header;
+    uint32_t      level_count;
+};
+
+struct SnapshotEnd {
+    MessageHeader header;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(PacketHeader) == 24);
+static_assert(sizeof(LevelUpdate) == 20);
+static_assert(sizeof(Trade) == 20);
+static_assert(sizeof(SnapshotBegin) == 8);
+static_assert(sizeof(SnapshotEnd) == 4);
+
+template<typename Msg>
+inline Msg make_message(MessageType type) {
+    static_assert(std::is_trivially_copyable_v<Msg>);
+    Msg msg{};
+    msg.header.length = static_cast<uint16_t>(sizeof(Msg));
+    msg.header.type   = type;
+    return msg;
+}
+
+// Walks the messages of one datagram. Returns false if the packet is
+// truncated or a message length does not fit.
+template<typename F>
+inline bool for_each_message(const char* data, size_t size, F&& f) {
+    if (size < sizeof(PacketHeader)) {
+        return false;
+    }
+    auto*  packet = reinterpret_cast<const PacketHeader*>(data);
+    size_t offset = sizeof(PacketHeader);
+    for (uint16_t i = 0; i < packet->message_count; ++i) {
+        if (size - offset < sizeof(MessageHeader)) {
+            return false;
+        }
+        auto* header = reinterpret_cast<const MessageHeader*>(data + offset);
+        if (header->length < sizeof(MessageHeader) || size - offset < header->length) {
+            return false;
+        }
+        f(packet->sequence + i, *header);
+        offset += header->length;
+    }
+    return true;
+}
+
+template<typename Msg>
+inline const Msg& message_cast(const MessageHeader& header) {
+    return *reinterpret_cast<const Msg*>(&header);
+}
+
+} // namespace hft::feed
@@ -0,0 +1,427 @@
+#pragma once
+
+#include "Concepts.hpp"
+#include "MarketDataFeed.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <boost/container/flat_map.hpp>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace hft {
+
+// Open-addressing hash table from venue order reference to a slot index.
+// Sized up front for the expected number of live orders; linear probing
+// with backward-shift deletion keeps probe chains short without tombstones.
+class OrderRefTable {
+public:
+    static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+    explicit OrderRefTable(size_t expected_orders) {
+        size_t capacity = 16;
+        while (capacity < expected_orders * 2) {
+            capacity <<= 1;
+        }
+        rehash(capacity);
+    }
+
+    uint32_t find(uint64_t key) const {
+        for (size_t i = home(key);; i = (i + 1) & mask_) {
+            const Slot& slot = slots_[i];
+            if (slot.value == kNone || slot.key == key) {
+                return slot.value;
+            }
+        }
+    }
+
+    // key must not already be present
+    void insert(uint64_t key, uint32_t value) {
+        if (unlikely((size_ + 1) * 10 > slots_.size() * 7)) {
+            rehash(slots_.size() * 2);
+        }
+        place(key, value);
+        ++size_;
+    }
+
+    uint32_t erase(uint64_t key) {
+        size_t i = home(key);
+        while (slots_[i].key != key) {
+            if (slots_[i].value == kNone) {
+                return kNone;
+            }
+            i = (i + 1) & mask_;
+        }
+        uint32_t value = slots_[i].value;
+        if (value == kNone) {
+            return kNone;
+        }
+
+        // Pull later entries of the probe chain back into the hole
+        for (size_t j = (i + 1) & mask_; slots_[j].value != kNone; j = (j + 1) & mask_) {
+            size_t k = home(slots_[j].key);
+            bool movable = i <= j ? (k <= i || k > j) : (k <= i && k > j);
+            if (movable) {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i].value = kNone;
+        --size_;
+        return value;
+    }
+
+    size_t size() const { return size_; }
+    size_t capacity() const { return slots_.size(); }
+
+private:
+    struct Slot {
+        uint64_t key;
+        uint32_t value;
+    };
+
+    size_t home(uint64_t key) const {
+        return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift_);
+    }
+
+    void place(uint64_t key, uint32_t value) {
+        size_t i = home(key);
+        while (slots_[i].value != kNone) {
+            i = (i + 1) & mask_;
+        }
+        slots_[i] = {key, value};
+    }
+
+    void rehash(size_t capacity) {
+        std::vector<Slot> old(capacity, Slot{0, kNone});
+        old.swap(slots_);
+        mask_ = capacity - 1;
+        shift_ = 64;
+        for (size_t c = capacity; c > 1; c >>= 1) {
+            --shift_;
+        }
+        for (const Slot& slot : old) {
+            if (slot.value != kNone) {
+                place(slot.key, slot.value);
+            }
+        }
+    }
+
+    std::vector<Slot> slots_;
+    size_t mask_ = 0;
+    size_t size_ = 0;
+    int shift_ = 64;
+};
+
+// Builds per-symbol order-by-order books from a venue's L3 feed. All
+// symbols of a venue share one pre-sized order table and node pool since
+// order references are unique per venue. Each price level keeps its
+// orders in time priority as an intrusive list and maintains its total
+// quantity and order count incrementally, so L1/L2 reads never re-aggregate.
+template<Price P, Quantity Q>
+class L3BookBuilder {
+public:
+    struct Level {
+        Q quantity = 0;
+        uint32_t order_count = 0;
+        uint32_t head = OrderRefTable::kNone;
+        uint32_t tail = OrderRefTable::kNone;
+    };
+
+    struct LevelView {
+        P price;
+        Q quantity;
+        uint32_t order_count;
+    };
+
+    struct OrderView {
+        uint64_t order_ref;
+        Q quantity;
+    };
+
+    class Book {
+    public:
+        P best_bid() const {
+            if (bids_.empty()) {
+                throw std::runtime_error("No bids available");
+            }
+            return bids_.begin()->first;
+        }
+
+        P best_ask() const {
+            if (asks_.empty()) {
+                throw std::runtime_error("No asks available");
+            }
+            return asks_.begin()->first;
+        }
+
+        Q volume_at_price(bool is_buy, P price) const {
+            if (is_buy) {
+                auto it = bids_.find(price);
+                return it == bids_.end() ? Q{0} : it->second.quantity;
+            }
+            auto it = asks_.find(price);
+            return it == asks_.end() ? Q{0} : it->second.quantity;
+        }
+
+        // Top `levels` price levels of one side, best first
+        std::vector<LevelView> depth(bool is_buy, size_t levels) const {
+            std::vector<LevelView> out;
+            out.reserve(levels);
+            auto collect = [&](const auto& side) {
+                for (auto it = side.begin(); it != side.end() && out.size() < levels; ++it) {
+                    out.push_back({it->first, it->second.quantity, it->second.order_count});
+                }
+            };
+            if (is_buy) {
+                collect(bids_);
+            } else {
+                collect(asks_);
+            }
+            return out;
+        }
+
+        size_t bid_levels() const { return bids_.size(); }
+        size_t ask_levels() const { return asks_.size(); }
+
+    private:
+        friend class L3BookBuilder;
+
+        boost::container::flat_map<P, Level, std::greater<P>> bids_;
+        boost::container::flat_map<P, Level, std::less<P>> asks_;
+    };
+
+    struct Stats {
+        uint64_t messages;
+        uint64_t unknown_orders;  // Events for references we never saw added, or for symbols out of range
+        uint64_t duplicate_orders;
+        uint64_t bad_quantities;  // Executes and cancels of zero or negative size
+    };
+
+    // Symbols index a dense vector, so anything past max_symbols is treated
+    // as unknown rather than trusted to size it
+    static constexpr size_t kMaxSymbols = 1 << 16;
+
+    explicit L3BookBuilder(size_t expected_orders = 1 << 20, size_t expected_symbols = 64,
+                           size_t max_symbols = kMaxSymbols)
+        : table_(expected_orders), max_symbols_(std::max(expected_symbols, max_symbols)) {
+        nodes_.reserve(expected_orders);
+        free_.reserve(expected_orders);
+        books_.reserve(expected_symbols);
+    }
+
+    // Returns false if the event referenced an unknown order or reused a
+    // live reference; the book is left unchanged in that case
+    bool apply(const OrderUpdate<P, Q>& update);
+
+    const Book& book(uint32_t symbol) const {
+        if (symbol >= books_.size()) {
+            throw std::out_of_range("Unknown symbol");
+        }
+        return books_[symbol];
+    }
+
+    // Live orders at one price in time priority
+    std::vector<OrderView> orders_at(uint32_t symbol, bool is_buy, P price) const;
+
+    size_t live_orders() const { return table_.size(); }
+    Stats stats() const { return stats_; }
+
+private:
+    struct OrderNode {
+        uint64_t ref;
+        P price;
+        Q quantity;
+        uint32_t symbol;
+        uint32_t prev;
+        uint32_t next;
+        bool is_buy;
+    };
+
+    bool add(uint64_t ref, uint32_t symbol, bool is_buy, P price, Q quantity);
+    bool reduce(uint64_t ref, Q quantity);
+    bool remove(uint64_t ref);
+    bool replace(uint64_t ref, uint64_t new_ref, P price, Q quantity);
+
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+
+    template<typename F>
+    static void with_side(Book& book, bool is_buy, F&& f) {
+        if (is_buy) {
+            f(book.bids_);
+        } else {
+            f(book.asks_);
+        }
+    }
+
+    OrderRefTable table_;
+    std::vector<OrderNode> nodes_;
+    std::vector<uint32_t> free_;
+    std::vector<Book> books_;
+    size_t max_symbols_;
+    Stats stats_{};
+};
+
+template<Price P, Quantity Q>
+bool L3BookBuilder<P, Q>::apply(const OrderUpdate<P, Q>& update) {
+    ++stats_.messages;
+    switch (update.type) {
+        case OrderEventType::Add:
+            return add(update.order_ref, update.symbol, update.is_buy, update.price, update.quantity);
+        case OrderEventType::Execute:
+        case OrderEventType::Cancel:
+            return reduce(update.order_ref, update.quantity);
+        case OrderEventType::Replace:
+            return replace(update.order_ref, update.new_order_ref, update.price, update.quantity);
+        case OrderEventType::Delete:
+            return remove(update.order_ref);
+    }
+    return false;
+}
+
+template<Price P, Quantity Q>
+std::vector<typename L3BookBuilder<P, Q>::OrderView>
+L3BookBuilder<P, Q>::orders_at(uint32_t symbol, bool is_buy, P price) const {
+    std::vector<OrderView> out;
+    const Book& b = book(symbol);
+    auto walk = [&](const auto& side) {
+        auto it = side.find(price);
+        if (it == side.end()) {
+            return;
+        }
+        for (uint32_t i = it->second.head; i != OrderRefTable::kNone; i = nodes_[i].next) {
+            out.push_back({nodes_[i].ref, nodes_[i].quantity});
+        }
+    };
+    if (is_buy) {
+        walk(b.bids_);
+    } else {
+        walk(b.asks_);
+    }
+    return out;
+}
+
+template<Price P, Quantity Q>
+bool L3BookBuilder<P, Q>::add(uint64_t ref, uint32_t symbol, bool is_buy, P price, Q quantity) {
+    if (table_.find(ref) != OrderRefTable::kNone) {
+        ++stats_.duplicate_orders;
+        return false;
+    }
+    if (unlikely(symbol >= max_symbols_)) {
+        ++stats_.unknown_orders;
+        return false;
+    }
+    if (symbol >= books_.size()) {
+        books_.resize(symbol + 1);
+    }
+
+    uint32_t index;
+    if (!free_.empty()) {
+        index = free_.back();
+        free_.pop_back();
+    } else {
+        index = static_cast<uint32_t>(nodes_.size());
+        nodes_.emplace_back();
+    }
+    nodes_[index] = {ref, price, quantity, symbol, OrderRefTable::kNone, OrderRefTable::kNone, is_buy};
+    table_.insert(ref, index);
+    link(index);
+    return true;
+}
+
+template<Price P, Quantity Q>
+bool L3BookBuilder<P, Q>::reduce(uint64_t ref, Q quantity) {
+    if (unlikely(quantity <= Q{0})) {
+        ++stats_.bad_quantities;  // A negative size would grow the order
+        return false;
+    }
+    uint32_t index = table_.find(ref);
+    if (index == OrderRefTable::kNone) {
+        ++stats_.unknown_orders;
+        return false;
+    }
+    OrderNode& node = nodes_[index];
+    if (quantity >= node.quantity) {
+        return remove(ref);
+    }
+
+    node.quantity -= quantity;
+    with_side(books_[node.symbol], node.is_buy, [&](auto& side) {
+        side.find(node.price)->second.quantity -= quantity;
+    });
+    return true;
+}
+
+template<Price P, Quantity Q>
+bool L3BookBuilder<P, Q>::remove(uint64_t ref) {
+    uint32_t index = table_.erase(ref);
+    if (index == OrderRefTable::kNone) {
+        ++stats_.unknown_orders;
+        return false;
+    }
+    unlink(index);
+    free_.push_back(index);
+    return true;
+}
+
+template<Price P, Quantity Q>
+bool L3BookBuilder<P, Q>::replace(uint64_t ref, uint64_t new_ref, P price, Q quantity) {
+    uint32_t index = table_.find(ref);
+    if (index == OrderRefTable::kNone) {
+        ++stats_.unknown_orders;
+        return false;
+    }
+    if (new_ref != ref && table_.find(new_ref) != OrderRefTable::kNone) {
+        ++stats_.duplicate_orders;
+        return false;
+    }
+
+    uint32_t symbol = nodes_[index].symbol;
+    bool is_buy = nodes_[index].is_buy;
+    remove(ref);
+    return add(new_ref, symbol, is_buy, price, quantity);
+}
+
+template<Price P, Quantity Q>
+void L3BookBuilder<P, Q>::link(uint32_t index) {
+    OrderNode& node = nodes_[index];
+    with_side(books_[node.symbol], node.is_buy, [&](auto& side) {
+        Level& level = side[node.price];
+        node.prev = level.tail;
+        if (level.tail != OrderRefTable::kNone) {
+            nodes_[level.tail].next = index;
+        } else {
+            level.head = index;
+        }
+        level.tail = index;
+        level.quantity += node.quantity;
+        ++level.order_count;
+    });
+}
+
+template<Price P, Quantity Q>
+void L3BookBuilder<P, Q>::unlink(uint32_t index) {
+    OrderNode& node = nodes_[index];
+    with_side(books_[node.symbol], node.is_buy, [&](auto& side) {
+        auto it = side.find(node.price);
+        Level& level = it->second;
+        if (node.prev != OrderRefTable::kNone) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            level.head = node.next;
+        }
+        if (node.next != OrderRefTable::kNone) {
+            nodes_[node.next].prev = node.prev;
+        } else {
+            level.tail = node.prev;
+        }
+        level.quantity -= node.quantity;
+        if (--level.order_count == 0) {
+            side.erase(it);
+        }
+    });
+}
+
+} // namespace hft
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+
+namespace hft {
+
+// Read-only memory mapping of a whole file. Pages are faulted in on
+// demand, so scanning a mapped capture never copies it through a buffer.
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return data_; }
+    size_t      size() const { return size_; }
+
+private:
+    void release();
+
+    const char* data_ = nullptr;
+    size_t      size_ = 0;
+};
+
+} // namespace hft
@@ -18,6 +18,27 @@ struct MarketUpdate {
     std::chrono::nanoseconds timestamp;
 };
 
+// Order-by-order (L3) feed events, keyed by the venue's order reference
+enum class OrderEventType : uint8_t {
+    Add,      // New resting order
+    Execute,  // quantity traded against order_ref
+    Cancel,   // quantity removed from order_ref, which stays live if anything remains
+    Replace,  // order_ref becomes new_order_ref at price/quantity, losing time priority
+    Delete,   // order_ref removed entirely
+};
+
+template<Price P, Quantity Q>
+struct OrderUpdate {
+    OrderEventType type;
+    uint32_t symbol;  // Venue locate code / dense symbol index
+    uint64_t order_ref;
+    uint64_t new_order_ref;  // Replace only
+    P price;                 // Add and Replace
+    Q quantity;
+    bool is_buy;             // Add only; later events inherit the side
+    std::chrono::nanoseconds timestamp;
+};
+
 class MarketDataFeed {
 public:
     template<Price P, Quantity Q>
@@ -0,0 +1,169 @@
+#pragma once
+
+#include "FeedProtocol.hpp"
+#include "MatchingEngine.hpp"
+#include "SpscRing.hpp"
+#include <atomic>
+#include <boost/container/flat_map.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace hft {
+
+struct PublisherConfig {
+    std::string               group             = "239.255.0.1";
+    uint16_t                  port              = 30001;
+    std::string               interface         = "127.0.0.1";  // Multicast egress interface
+    int                       ttl               = 1;
+    size_t                    max_packet_size   = 1472;  // 1500 byte MTU minus IP and UDP headers
+    size_t                    ring_capacity     = 1 << 16;
+    std::chrono::milliseconds snapshot_interval = std::chrono::milliseconds(1000);
+    int                       cpu               = -1;  // Core to pin the encoder to, -1 leaves it unpinned
+    size_t                    idle_spins        = 64;  // Empty polls before an unpinned encoder blocks
+};
+
+// Publishes book changes as a sequenced UDP multicast feed (see FeedProtocol.hpp).
+//
+// The engine-side hooks only copy a small event into an SPSC ring; a
+// dedicated encoder thread drains the ring, keeps a shadow copy of the
+// aggregated book, packs messages into MTU-sized datagrams and emits
+// periodic snapshots from the shadow book. Matching never waits on
+// encoding or on the socket: if the ring fills, level changes are
+// conflated per price in an overflow book and trades are dropped until the
+// encoder catches up, publishes the conflated levels and a fresh snapshot.
+// The same overflow book collects level changes while the publisher is
+// stopped, so start() resumes from the engine's current book.
+//
+// A pinned encoder spins on its core. An unpinned one blocks once it has
+// been idle for idle_spins polls and is woken by the next event.
+class MarketDataPublisher {
+public:
+    using Engine = MatchingEngine<double, int64_t, uint64_t>;
+
+    struct Stats {
+        uint64_t messages;
+        uint64_t packets;
+        uint64_t snapshots;
+        uint64_t bytes;
+        uint64_t send_errors;
+        uint64_t ring_full;       // Events that found the ring full or arrived while it recovered
+        uint64_t trades_dropped;  // Trades lost to a full ring or a stopped publisher
+    };
+
+    explicit MarketDataPublisher(PublisherConfig config = {});
+    ~MarketDataPublisher();
+
+    MarketDataPublisher(const MarketDataPublisher&)            = delete;
+    MarketDataPublisher& operator=(const MarketDataPublisher&) = delete;
+
+    // Installs the level and trade callbacks on the engine. Levels that
+    // already exist are not seen, so attach before the engine takes orders.
+    // The destructor removes the callbacks again, so the engine must not be
+    // matching on another thread while the publisher is destroyed.
+    void attach(Engine& engine);
+    void detach();
+
+    // Producer side. Safe to call from several threads; pushes are serialised
+    // by a spin lock that is uncontended with a single submitting thread.
+    // While the publisher is stopped level changes are conflated and
+    // published on the next start(); trades are dropped.
+    void on_level(LevelAction action, bool is_buy, double price, int64_t quantity);
+    void on_trade(double price, int64_t quantity, bool aggressor_is_buy);
+
+    void start();
+    void stop();  // Drains and publishes everything queued before returning
+
+    Stats stats() const;
+
+private:
+    enum class EventKind : uint8_t { Add, Modify, Delete, Trade };
+
+    struct BookEvent {
+        EventKind kind;
+        bool      is_buy;
+        int64_t   price;
+        int64_t   quantity;
+    };
+
+    void push(const BookEvent& event);
+    void run();
+    void encode(const BookEvent& event);
+    void publish_snapshot();
+    void recover();
+    void wait_for_events();
+
+    template<typename Msg>
+    void append(const Msg& msg);
+    void flush_packet();
+
+    PublisherConfig     config_;
+    SpscRing<BookEvent> ring_;
+    std::atomic_flag    producer_lock_ = ATOMIC_FLAG_INIT;
+    Engine*             engine_        = nullptr;
+
+    // Level totals conflated while the ring is full, guarded by producer_lock_.
+    // While overflowed_ is set every level change lands here, so nothing in
+    // the ring is newer than what is in these maps.
+    std::atomic<bool>                                                   overflowed_{false};
+    boost::container::flat_map<int64_t, int64_t, std::greater<int64_t>> overflow_bids_;
+    boost::container::flat_map<int64_t, int64_t, std::less<int64_t>>    overflow_asks_;
+
+    int               socket_fd_ = -1;
+    std::atomic<bool> running_;
+    std::thread       worker_;
+
+    // Set under producer_lock_ by an idle encoder; the next push clears it
+    // and wakes the encoder through wake_
+    std::atomic<bool>       sleeping_{false};
+    std::mutex              wake_mutex_;
+    std::condition_variable wake_;
+
+    // Encoder state, only touched by worker_
+    boost::container::flat_map<int64_t, int64_t, std::greater<int64_t>> bids_;
+    boost::container::flat_map<int64_t, int64_t, std::less<int64_t>>    asks_;
+    std::vector<char>                                                   packet_;
+    uint16_t                                                            packet_messages_ = 0;
+    uint64_t                                                            next_sequence_   = 1;
+    std::chrono::steady_clock::time_point                               next_snapshot_;
+    boost::container::flat_map<int64_t, int64_t, std::greater<int64_t>> recovered_bids_;
+    boost::container::flat_map<int64_t, int64_t, std::less<int64_t>>    recovered_asks_;
+
+    alignas(64) std::atomic<uint64_t> messages_{0};
+    std::atomic<uint64_t>             packets_{0};
+    std::atomic<uint64_t>             snapshots_{0};
+    std::atomic<uint64_t>             bytes_{0};
+    std::atomic<uint64_t>             send_errors_{0};
+    alignas(64) std::atomic<uint64_t> ring_full_{0};
+    std::atomic<uint64_t>             trades_dropped_{0};
+};
+
+// Joins a feed's multicast group and hands back raw datagrams; pair with
+// feed::for_each_message to decode them
+class MarketDataReceiver {
+public:
+    MarketDataReceiver() = default;
+    ~MarketDataReceiver();
+
+    MarketDataReceiver(const MarketDataReceiver&)            = delete;
+    MarketDataReceiver& operator=(const MarketDataReceiver&) = delete;
+
+    // Port 0 binds an ephemeral port, see port()
+    void open(const std::string& group, uint16_t port, const std::string& interface = "127.0.0.1");
+    void close();
+
+    uint16_t port() const { return port_; }
+
+    // Returns the datagram size, or 0 if nothing arrived within timeout
+    size_t receive(char* buffer, size_t capacity, std::chrono::milliseconds timeout);
+
+private:
+    int      fd_   = -1;
+    uint16_t port_ = 0;
+};
+
+} // namespace hft
@@ -11,17 +11,31 @@ template<Price P, Quantity Q, OrderId ID>
 class MatchingEngine {
 public:
     using OrderCallback = std::function<void(const ID&, P, Q)>;
+    using TradeCallback = std::function<void(P price, Q quantity, bool aggressor_is_buy)>;
+    using LevelCallback = typename OrderBook<P, Q, ID>::LevelCallback;
     
     void set_fill_callback(OrderCallback callback) {
         fill_callback_ = std::move(callback);
     }
 
+    const OrderCallback& fill_callback() const { return fill_callback_; }
+
+    // Market data hooks: every trade, and every aggregated level change in the book
+    void set_trade_callback(TradeCallback callback) {
+        trade_callback_ = std::move(callback);
+    }
+
+    void set_level_callback(LevelCallback callback) {
+        order_book_.set_level_callback(std::move(callback));
+    }
+
     void handle_order(typename OrderBook<P, Q, ID>::Order order);
     void cancel_order(const ID& order_id);
 
 private:
     OrderBook<P, Q, ID> order_book_;
     OrderCallback fill_callback_;
+    TradeCallback trade_callback_;
     std::mutex engine_mutex_;
     
     void match_order(const typename OrderBook<P, Q, ID>::Order& order);
@@ -39,6 +53,9 @@ void MatchingEngine<P, Q, ID>::handle_order(typename OrderBook<P, Q, ID>::Order
                 if (fill_callback_) {
                     fill_callback_(order.id, best_ask, order.quantity);
                 }
+                if (trade_callback_) {
+                    trade_callback_(best_ask, order.quantity, true);
+                }
             }
         } else {
             P best_bid = order_book_.best_bid();
@@ -46,6 +63,9 @@ void MatchingEngine<P, Q, ID>::handle_order(typename OrderBook<P, Q, ID>::Order
                 if (fill_callback_) {
                     fill_callback_(order.id, best_bid, order.quantity);
                 }
+                if (trade_callback_) {
+                    trade_callback_(best_bid, order.quantity, false);
+                }
             }
         }
     } catch (const std::runtime_error&) {
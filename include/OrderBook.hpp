@@ -4,10 +4,18 @@
 #include <unordered_map>
 #include <memory>
 #include <boost/container/flat_map.hpp>
+#include <functional>
 #include <mutex>
 
 namespace hft {
 
+// How an aggregated price level changed
+enum class LevelAction : uint8_t {
+    Add,     // New price level
+    Modify,  // Existing level's quantity changed
+    Delete,  // Level emptied and removed
+};
+
 template<Price P, Quantity Q, OrderId ID>
 class OrderBook {
 public:
@@ -19,6 +27,14 @@ public:
         std::chrono::nanoseconds timestamp;
     };
 
+    // Invoked with the level's new total (zero on Delete) while the book
+    // lock is held, so it must be cheap and must not call back into the book
+    using LevelCallback = std::function<void(LevelAction action, bool is_buy, P price, Q quantity)>;
+
+    void set_level_callback(LevelCallback callback) {
+        level_callback_ = std::move(callback);
+    }
+
     // Core operations
     void add_order(Order order);
     void cancel_order(const ID& order_id);
@@ -34,15 +50,49 @@ private:
     boost::container::flat_map<P, Q, std::less<P>> asks_;     // Price-time priority
     std::unordered_map<ID, Order> orders_;  // Quick order lookup
     mutable std::mutex book_mutex_;
+    LevelCallback level_callback_;
+
+    template<typename Levels>
+    void update_level(Levels& levels, bool is_buy, P price, Q delta);
 };
 
+template<Price P, Quantity Q, OrderId ID>
+template<typename Levels>
+void OrderBook<P, Q, ID>::update_level(Levels& levels, bool is_buy, P price, Q delta) {
+    if (delta == 0) {
+        return;
+    }
+
+    LevelAction action;
+    Q total;
+    auto it = levels.find(price);
+    if (it == levels.end()) {
+        levels.emplace(price, delta);
+        action = LevelAction::Add;
+        total = delta;
+    } else {
+        it->second += delta;
+        total = it->second;
+        if (total == 0) {
+            levels.erase(it);
+            action = LevelAction::Delete;
+        } else {
+            action = LevelAction::Modify;
+        }
+    }
+
+    if (level_callback_) {
+        level_callback_(action, is_buy, price, total);
+    }
+}
+
 template<Price P, Quantity Q, OrderId ID>
 void OrderBook<P, Q, ID>::add_order(Order order) {
     std::lock_guard<std::mutex> lock(book_mutex_);
     if (order.is_buy) {
-        bids_[order.price] += order.quantity;
+        update_level(bids_, true, order.price, order.quantity);
     } else {
-        asks_[order.price] += order.quantity;
+        update_level(asks_, false, order.price, order.quantity);
     }
     orders_[order.id] = std::move(order);
 }
@@ -57,15 +107,9 @@ void OrderBook<P, Q, ID>::cancel_order(const ID& order_id) {
 
     auto& order = it->second;
     if (order.is_buy) {
-        bids_[order.price] -= order.quantity;
-        if (bids_[order.price] == 0) {
-            bids_.erase(order.price);
-        }
+        update_level(bids_, true, order.price, -order.quantity);
     } else {
-        asks_[order.price] -= order.quantity;
-        if (asks_[order.price] == 0) {
-            asks_.erase(order.price);
-        }
+        update_level(asks_, false, order.price, -order.quantity);
     }
     
     orders_.erase(it);
@@ -80,17 +124,9 @@ void OrderBook<P, Q, ID>::modify_order(const ID& order_id, Q new_quantity) {
 
     auto& order = it->second;
     if (order.is_buy) {
-        bids_[order.price] -= order.quantity;
-        bids_[order.price] += new_quantity;
-        if (bids_[order.price] == 0) {
-            bids_.erase(order.price);
-        }
+        update_level(bids_, true, order.price, new_quantity - order.quantity);
     } else {
-        asks_[order.price] -= order.quantity;
-        asks_[order.price] += new_quantity;
-        if (asks_[order.price] == 0) {
-            asks_.erase(order.price);
-        }
+        update_level(asks_, false, order.price, new_quantity - order.quantity);
     }
     
     order.quantity = new_quantity;
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "MatchingEngine.hpp"
+#include "OrderProtocol.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace hft {
+
+struct GatewayConfig {
+    std::string bind_address     = "127.0.0.1";
+    uint16_t    port             = 0;   // 0 picks an ephemeral port, see OrderGateway::port()
+    int         cpu              = -1;  // Core to pin the event loop to, -1 leaves it unpinned
+    int         listen_backlog   = 128;
+    int         max_events       = 256;
+    size_t      recv_buffer_size = 64 * 1024;
+    size_t      max_pending_out  = 4 * 1024 * 1024;  // Unsent bytes before a slow reader is disconnected
+};
+
+// TCP order entry gateway. A single epoll event loop thread owns every
+// session and is the only caller into the engine, so the engine sees one
+// submitting thread no matter how many clients are connected.
+//
+// Each loop iteration runs in three phases:
+//   1. read every ready socket and frame messages in place in its receive buffer
+//   2. submit the whole batch of decoded requests to the engine
+//   3. write each session's queued acks/fills/rejects with one send() per socket
+class OrderGateway {
+public:
+    using Engine = MatchingEngine<double, int64_t, uint64_t>;
+
+    struct Stats {
+        uint64_t messages_in;
+        uint64_t messages_out;
+        uint64_t rejects;
+        uint64_t socket_writes;
+        uint64_t batches;
+        uint64_t connections;
+    };
+
+    explicit OrderGateway(Engine& engine, GatewayConfig config = {});
+    ~OrderGateway();
+
+    OrderGateway(const OrderGateway&)            = delete;
+    OrderGateway& operator=(const OrderGateway&) = delete;
+
+    // Binds and listens before returning, so port() is valid afterwards.
+    // The engine's fill callback is borrowed while running and handed back
+    // by stop().
+    void start();
+    void stop();
+
+    uint16_t port() const { return port_; }
+    Stats    stats() const;
+
+private:
+    struct Session;
+
+    struct Command {
+        Session*                         session;
+        const protocol::MessageHeader*   header;  // Points into session's receive buffer
+    };
+
+    struct OrderRef {
+        Session* session;
+        uint64_t client_order_id;
+    };
+
+    struct PendingFill {
+        uint64_t order_id;
+        double   price;
+        int64_t  quantity;
+    };
+
+    void run();
+    void accept_connections();
+    void read_session(Session& session);
+    void submit_batch();
+    void flush(Session& session);
+    void close_session(Session& session);
+
+    void handle_new_order(Session& session, const protocol::NewOrder& msg);
+    void handle_cancel(Session& session, const protocol::CancelOrder& msg);
+    void handle_replace(Session& session, const protocol::ReplaceOrder& msg);
+
+    bool submit_to_engine(Session& session, uint64_t client_order_id, double price, int64_t quantity,
+                          bool is_buy, uint64_t& order_id);
+    bool cancel_in_engine(Session& session, uint64_t client_order_id);
+    void send_ack(Session& session, protocol::MessageType type, uint64_t client_order_id, uint64_t order_id,
+                  uint64_t client_timestamp);
+    void send_reject(Session& session, protocol::MessageType type, protocol::RejectReason reason,
+                     uint64_t client_order_id, uint64_t client_timestamp);
+    void drain_fills();
+
+    static bool valid_order(int64_t price, uint32_t quantity) { return price > 0 && quantity > 0; }
+
+    template<typename Msg>
+    void enqueue(Session& session, const Msg& msg);
+
+    Engine&               engine_;
+    GatewayConfig         config_;
+    Engine::OrderCallback previous_fill_callback_;
+
+    int      listen_fd_ = -1;
+    int      epoll_fd_  = -1;
+    int      wake_fd_   = -1;
+    uint16_t port_      = 0;
+
+    std::atomic<bool> running_;
+    std::thread       worker_;
+
+    // Event loop state, only touched by worker_
+    std::unordered_map<int, std::unique_ptr<Session>> sessions_;
+    std::unordered_map<uint64_t, OrderRef>            orders_;  // Engine order id -> owner
+    std::vector<Command>                              batch_;
+    std::vector<Session*>                             active_;
+    std::vector<PendingFill>                          pending_fills_;
+    std::chrono::nanoseconds                          batch_time_{0};
+
+    alignas(64) std::atomic<uint64_t> messages_in_{0};
+    std::atomic<uint64_t>             messages_out_{0};
+    std::atomic<uint64_t>             rejects_{0};
+    std::atomic<uint64_t>             socket_writes_{0};
+    std::atomic<uint64_t>             batches_{0};
+    std::atomic<uint64_t>             connections_{0};
+};
+
+// Minimal blocking client for the gateway protocol, used by the load
+// generator and the tests
+class OrderGatewayClient {
+public:
+    OrderGatewayClient();
+    ~OrderGatewayClient();
+
+    OrderGatewayClient(const OrderGatewayClient&)            = delete;
+    OrderGatewayClient& operator=(const OrderGatewayClient&) = delete;
+
+    void connect(const std::string& host, uint16_t port);
+    void close();
+
+    void send_new_order(uint64_t client_order_id, double price, uint32_t quantity, bool is_buy,
+                        uint64_t client_timestamp = 0);
+    void send_cancel(uint64_t client_order_id, uint64_t client_timestamp = 0);
+    void send_replace(uint64_t orig_client_order_id, uint64_t client_order_id, double price, uint32_t quantity,
+                      uint64_t client_timestamp = 0);
+    void send_raw(const void* data, size_t size);
+
+    // Blocks until a complete message arrives. The reference stays valid
+    // until the next call to receive().
+    const protocol::MessageHeader& receive();
+
+private:
+    template<typename Msg>
+    void send(const Msg& msg) { send_raw(&msg, sizeof(msg)); }
+
+    int               fd_ = -1;
+    std::vector<char> buffer_;
+    size_t            head_ = 0;
+    size_t            tail_ = 0;
+};
+
+} // namespace hft
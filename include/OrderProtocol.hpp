@@ -0,0 +1,181 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+namespace hft::protocol {
+
+// Compact fixed-layout binary session protocol used by the order gateway.
+// All fields are little-endian host order and every message starts with a
+// MessageHeader whose length covers the whole message, so frames can be
+// decoded in place straight out of the receive buffer.
+
+// Prices travel as integer ticks of 1 / kPriceScale
+inline constexpr int64_t kPriceScale = 10000;
+
+inline constexpr int64_t to_ticks(double price) {
+    return static_cast<int64_t>(price * kPriceScale + (price >= 0 ? 0.5 : -0.5));
+}
+
+inline constexpr double from_ticks(int64_t ticks) {
+    return static_cast<double>(ticks) / kPriceScale;
+}
+
+enum class MessageType : uint8_t {
+    NewOrder     = 1,
+    CancelOrder  = 2,
+    ReplaceOrder = 3,
+    Ack          = 10,
+    Fill         = 11,
+    Reject       = 12,
+};
+
+enum class RejectReason : uint8_t {
+    None         = 0,
+    Malformed    = 1,
+    UnknownOrder = 2,
+    DuplicateId  = 3,
+    EngineError  = 4,
+};
+
+#pragma pack(push, 1)
+
+struct MessageHeader {
+    uint16_t    length;
+    MessageType type;
+    uint8_t     reserved;
+};
+
+struct NewOrder {
+    MessageHeader header;
+    uint64_t      client_order_id;
+    int64_t       price;
+    uint32_t      quantity;
+    uint8_t       is_buy;
+    uint8_t       padding[3];
+    uint64_t      client_timestamp;  // Echoed back on the ack
+};
+
+struct CancelOrder {
+    MessageHeader header;
+    uint64_t      client_order_id;
+    uint64_t      client_timestamp;
+};
+
+struct ReplaceOrder {
+    MessageHeader header;
+    uint64_t      orig_client_order_id;
+    uint64_t      client_order_id;
+    int64_t       price;
+    uint32_t      quantity;
+    uint8_t       padding[4];
+    uint64_t      client_timestamp;
+};
+
+struct Ack {
+    MessageHeader header;
+    MessageType   acked_type;
+    uint8_t       padding[7];
+    uint64_t      client_order_id;
+    uint64_t      order_id;  // Engine-assigned id, zero for cancels
+    uint64_t      client_timestamp;
+};
+
+struct Fill {
+    MessageHeader header;
+    uint64_t      client_order_id;
+    uint64_t      order_id;
+    int64_t       price;
+    uint32_t      quantity;
+    uint8_t       padding[4];
+};
+
+struct Reject {
+    MessageHeader header;
+    MessageType   rejected_type;
+    RejectReason  reason;
+    uint8_t       padding[6];
+    uint64_t      client_order_id;
+    uint64_t      client_timestamp;
+};
+
+#pragma pack(pop)
+
+static_assert(sizeof(MessageHeader) == 4);
+static_assert(sizeof(NewOrder) == 36);
+static_assert(sizeof(CancelOrder) == 20);
+static_assert(sizeof(ReplaceOrder) == 44);
+static_assert(sizeof(Ack) == 36);
+static_assert(sizeof(Fill) == 36);
+static_assert(sizeof(Reject) == 28);
+
+inline constexpr size_t kMaxMessageSize = sizeof(ReplaceOrder);
+
+template<typename Msg>
+struct MessageTraits;
+
+template<> struct MessageTraits<NewOrder>     { static constexpr MessageType type = MessageType::NewOrder; };
+template<> struct MessageTraits<CancelOrder>  { static constexpr MessageType type = MessageType::CancelOrder; };
+template<> struct MessageTraits<ReplaceOrder> { static constexpr MessageType type = MessageType::ReplaceOrder; };
+template<> struct MessageTraits<Ack>          { static constexpr MessageType type = MessageType::Ack; };
+template<> struct MessageTraits<Fill>         { static constexpr MessageType type = MessageType::Fill; };
+template<> struct MessageTraits<Reject>       { static constexpr MessageType type = MessageType::Reject; };
+
+// Expected wire size for a message type, zero if the type is unknown
+inline constexpr size_t message_size(MessageType type) {
+    switch (type) {
+        case MessageType::NewOrder:     return sizeof(NewOrder);
+        case MessageType::CancelOrder:  return sizeof(CancelOrder);
+        case MessageType::ReplaceOrder: return sizeof(ReplaceOrder);
+        case MessageType::Ack:          return sizeof(Ack);
+        case MessageType::Fill:         return sizeof(Fill);
+        case MessageType::Reject:       return sizeof(Reject);
+    }
+    return 0;
+}
+
+// Returns a zero-initialised message with its header filled in
+template<typename Msg>
+inline Msg make_message() {
+    static_assert(std::is_trivially_copyable_v<Msg>);
+    Msg msg{};
+    msg.header.length = static_cast<uint16_t>(sizeof(Msg));
+    msg.header.type   = MessageTraits<Msg>::type;
+    return msg;
+}
+
+enum class DecodeStatus {
+    Ok,          // A complete, well-formed frame is available
+    Incomplete,  // Need more bytes
+    Malformed,   // Unknown type or length mismatch; the stream cannot be resynchronised
+};
+
+struct DecodeResult {
+    DecodeStatus         status;
+    const MessageHeader* header;
+};
+
+// Frames the next message in [data, data + size) without copying it
+inline DecodeResult decode(const char* data, size_t size) {
+    if (size < sizeof(MessageHeader)) {
+        return {DecodeStatus::Incomplete, nullptr};
+    }
+    auto*  header   = reinterpret_cast<const MessageHeader*>(data);
+    size_t expected = message_size(header->type);
+    if (expected == 0 || header->length != expected) {
+        return {DecodeStatus::Malformed, header};
+    }
+    if (size < expected) {
+        return {DecodeStatus::Incomplete, nullptr};
+    }
+    return {DecodeStatus::Ok, header};
+}
+
+template<typename Msg>
+inline const Msg& message_cast(const MessageHeader* header) {
+    return *reinterpret_cast<const Msg*>(header);
+}
+
+} // namespace hft::protocol
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "MappedFile.hpp"
+#include "MarketDataFeed.hpp"
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <type_traits>
+
+namespace hft {
+
+// Raw recorded session: a SessionFileHeader followed by record_count
+// MarketUpdate<double, int64_t> records exactly as they sit in memory,
+// so a mapped file is read in place without decoding.
+using RecordedUpdate = MarketUpdate<double, int64_t>;
+
+static_assert(std::is_trivially_copyable_v<RecordedUpdate>);
+static_assert(sizeof(RecordedUpdate) == 32);
+
+struct SessionFileHeader {
+    char     magic[4];  // "HFTS"
+    uint32_t version;
+    uint64_t record_count;
+};
+
+inline constexpr uint32_t kSessionFileVersion = 1;
+
+void write_session_file(const std::filesystem::path& path, std::span<const RecordedUpdate> updates);
+
+class SessionReader {
+public:
+    // Throws std::runtime_error if the file is not a session file or is truncated
+    explicit SessionReader(const std::filesystem::path& path);
+
+    std::span<const RecordedUpdate> updates() const { return updates_; }
+
+private:
+    MappedFile                      file_;
+    std::span<const RecordedUpdate> updates_;
+};
+
+} // namespace hft
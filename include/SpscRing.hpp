@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+namespace hft {
+
+// Bounded single-producer/single-consumer ring buffer. Capacity must be a
+// power of two. Each side caches the other side's index so the shared
+// cache lines are only touched when the cached view runs out.
+template<typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>, "SpscRing slots are copied, not constructed");
+
+public:
+    explicit SpscRing(size_t capacity) : capacity_(capacity), mask_(capacity - 1), slots_(new T[capacity]) {
+        if (capacity < 2 || (capacity & mask_) != 0) {
+            throw std::invalid_argument("SpscRing capacity must be a power of two");
+        }
+    }
+
+    SpscRing(const SpscRing&)            = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer side
+    bool try_push(const T& value) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == capacity_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == capacity_) {
+                return false;
+            }
+        }
+        slots_[tail & mask_] = value;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side
+    bool try_pop(T& value) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        value = slots_[head & mask_];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate when called concurrently with either side
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    bool   empty() const { return size() == 0; }
+    size_t capacity() const { return capacity_; }
+
+private:
+    const size_t         capacity_;
+    const size_t         mask_;
+    std::unique_ptr<T[]> slots_;
+
+    alignas(64) std::atomic<size_t> head_{0};  // Consumer index
+    size_t cached_tail_ = 0;                   // Consumer's view of tail_
+
+    alignas(64) std::atomic<size_t> tail_{0};  // Producer index
+    size_t cached_head_ = 0;                   // Producer's view of head_
+};
+
+} // namespace hft
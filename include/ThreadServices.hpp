@@ -0,0 +1,163 @@
+#pragma once
+
+#include "Utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HFT_HAS_TSC 1
+#endif
+
+namespace hft::utils {
+
+// IDs reserved from the global counter a block at a time, so a thread
+// touches the shared cache line once per block instead of once per order.
+// IDs stay unique alongside generate_order_id() but are not ordered across
+// threads: a quiet thread keeps issuing from its old block long after busier
+// ones have moved past it, so never compare IDs to order events in time.
+class OrderIdBlock {
+public:
+    static constexpr uint64_t kDefaultBlockSize = 1024;
+
+    constexpr explicit OrderIdBlock(uint64_t block_size = kDefaultBlockSize) : block_size_(block_size) {}
+
+    uint64_t next() {
+        if (unlikely(next_ == end_)) {
+            next_ = order_id_counter().fetch_add(block_size_, std::memory_order_relaxed) + 1;
+            end_  = next_ + block_size_;
+        }
+        return next_++;
+    }
+
+private:
+    uint64_t block_size_;
+    uint64_t next_ = 0;
+    uint64_t end_  = 0;
+};
+
+#ifdef HFT_HAS_TSC
+// Measured once per process against steady_clock; assumes an invariant TSC
+inline double tsc_ns_per_tick() {
+    static const double ratio = [] {
+        auto     start_time = std::chrono::steady_clock::now();
+        uint64_t start_tsc  = __rdtsc();
+        auto     end_time   = start_time;
+        while (end_time - start_time < std::chrono::milliseconds(2)) {
+            end_time = std::chrono::steady_clock::now();
+        }
+        uint64_t end_tsc = __rdtsc();
+        return std::chrono::duration<double, std::nano>(end_time - start_time).count() /
+               static_cast<double>(end_tsc - start_tsc);
+    }();
+    return ratio;
+}
+#endif
+
+// Per-thread wall clock in the same epoch as current_time(). now() reads
+// the TSC and extrapolates from an anchor that is re-taken from the system
+// clock every kReanchorInterval; it never steps backwards on a thread.
+// coarse() is the kernel's tick-granularity clock for stamps that only
+// need millisecond accuracy.
+class ThreadClock {
+public:
+    static constexpr std::chrono::nanoseconds kReanchorInterval = std::chrono::milliseconds(100);
+
+    static ThreadClock& local() {
+        thread_local ThreadClock clock;
+        return clock;
+    }
+
+    std::chrono::nanoseconds now() {
+#ifdef HFT_HAS_TSC
+        uint64_t elapsed = __rdtsc() - anchor_tsc_;
+        if (unlikely(elapsed >= reanchor_ticks_)) {
+            anchor();
+            elapsed = 0;
+        }
+        int64_t ns = anchor_ns_ + static_cast<int64_t>(static_cast<double>(elapsed) * ns_per_tick_);
+        if (unlikely(ns < last_ns_)) {
+            ns = last_ns_;
+        }
+        last_ns_ = ns;
+        return std::chrono::nanoseconds(ns);
+#else
+        return current_time();
+#endif
+    }
+
+    static std::chrono::nanoseconds coarse() {
+#ifdef __linux__
+        timespec ts;
+        clock_gettime(CLOCK_REALTIME_COARSE, &ts);
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+#else
+        return current_time();
+#endif
+    }
+
+    // One clock read for a whole batch of orders (anything with a timestamp member)
+    template<typename Range>
+    void stamp(Range& orders) {
+        auto timestamp = now();
+        for (auto& order : orders) {
+            order.timestamp = timestamp;
+        }
+    }
+
+private:
+#ifdef HFT_HAS_TSC
+    void anchor() {
+        uint64_t tsc = __rdtsc();
+        int64_t  ns  = current_time().count();
+        if (origin_tsc_ == 0) {
+            origin_tsc_  = tsc;
+            origin_ns_   = ns;
+            ns_per_tick_ = tsc_ns_per_tick();
+        } else {
+            // Refine the rate over the thread's whole lifetime, ignoring
+            // anything a wall clock step would make implausible
+            double measured = static_cast<double>(ns - origin_ns_) / static_cast<double>(tsc - origin_tsc_);
+            double expected = tsc_ns_per_tick();
+            if (measured > expected * 0.99 && measured < expected * 1.01) {
+                ns_per_tick_ = measured;
+            }
+        }
+        anchor_tsc_     = tsc;
+        anchor_ns_      = ns;
+        reanchor_ticks_ = static_cast<uint64_t>(static_cast<double>(kReanchorInterval.count()) / ns_per_tick_);
+    }
+
+    // Zero-initialised so the thread_local needs no construction guard;
+    // the first now() anchors
+    uint64_t anchor_tsc_     = 0;
+    uint64_t reanchor_ticks_ = 0;
+    int64_t  anchor_ns_      = 0;
+    int64_t  last_ns_        = 0;
+    double   ns_per_tick_    = 0.0;
+    uint64_t origin_tsc_     = 0;
+    int64_t  origin_ns_      = 0;
+#endif
+};
+
+// Runs the one-off TSC calibration (a ~2ms busy wait) on the calling thread,
+// so it isn't paid by the first thread_time() on a hot path. Components that
+// stamp with thread_time() call this from start().
+inline void calibrate_clock() {
+#ifdef HFT_HAS_TSC
+    tsc_ns_per_tick();
+#endif
+}
+
+// Contention-free replacements for generate_order_id() and current_time()
+inline uint64_t thread_order_id() {
+    thread_local OrderIdBlock block;
+    return block.next();
+}
+
+inline std::chrono::nanoseconds thread_time() {
+    return ThreadClock::local().now();
+}
+
+} // namespace hft::utils
@@ -0,0 +1,327 @@
+#pragma once
+
+#include "ColumnarCodec.hpp"
+#include "MappedFile.hpp"
+#include "OrderProtocol.hpp"
+#include "SessionFile.hpp"
+#include "Utils.hpp"
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+namespace hft {
+
+// One engine fill as archived next to the market data it traded against
+struct FillRecord {
+    uint64_t                 order_id;
+    double                   price;
+    int64_t                  quantity;
+    std::chrono::nanoseconds timestamp;
+};
+
+enum class TickStreamKind : uint32_t {
+    MarketUpdates = 1,
+    Fills         = 2,
+};
+
+// Columnar tick file:
+//
+//   TickFileHeader
+//   block 0: column 0 | column 1 | ...   (columnar codec, 8-byte aligned)
+//   block 1: ...
+//   TickBlockIndex[block_count]           (at index_offset)
+//
+// Every block holds block_size records except the last. Column 0 is always
+// the timestamp and column 1 the price in ticks of 1 / price_scale, so the
+// index can carry their per-block range and queries skip blocks without
+// touching them.
+struct TickFileHeader {
+    char     magic[4];  // "HFTC"
+    uint32_t version;
+    uint32_t kind;
+    uint32_t block_size;
+    uint64_t record_count;
+    uint64_t block_count;
+    uint64_t index_offset;
+    int64_t  price_scale;
+};
+
+struct TickBlockIndex {
+    uint64_t offset;  // Bytes from the start of the file
+    uint32_t count;
+    uint32_t reserved;
+    int64_t  min_timestamp;  // Nanoseconds
+    int64_t  max_timestamp;
+    int64_t  min_price;  // Ticks of 1 / price_scale
+    int64_t  max_price;
+};
+
+static_assert(sizeof(TickFileHeader) % sizeof(uint64_t) == 0);
+static_assert(sizeof(TickBlockIndex) % sizeof(uint64_t) == 0);
+
+inline constexpr uint32_t kTickFileVersion      = 1;
+inline constexpr size_t   kDefaultTickBlockSize = 4096;
+
+inline int64_t price_to_ticks(double price, int64_t price_scale) {
+    return std::llround(price * static_cast<double>(price_scale));
+}
+
+inline double ticks_to_price(int64_t ticks, int64_t price_scale) {
+    return static_cast<double>(ticks) / static_cast<double>(price_scale);
+}
+
+// How each record type maps onto integer columns
+template<typename R>
+struct TickColumns;
+
+template<>
+struct TickColumns<RecordedUpdate> {
+    static constexpr TickStreamKind kind = TickStreamKind::MarketUpdates;
+    static constexpr std::array<columnar::ColumnEncoding, 4> encodings{
+        columnar::ColumnEncoding::Delta,             // timestamp
+        columnar::ColumnEncoding::Delta,             // price
+        columnar::ColumnEncoding::FrameOfReference,  // quantity
+        columnar::ColumnEncoding::FrameOfReference,  // is_buy
+    };
+
+    static double price(const RecordedUpdate& update) { return update.price; }
+
+    static void split(const RecordedUpdate& update, int64_t price_scale, int64_t* row) {
+        row[0] = update.timestamp.count();
+        row[1] = price_to_ticks(update.price, price_scale);
+        row[2] = update.quantity;
+        row[3] = update.is_buy ? 1 : 0;
+    }
+
+    static RecordedUpdate join(const int64_t* const* columns, int64_t price_scale, size_t i) {
+        return {ticks_to_price(columns[1][i], price_scale), columns[2][i], columns[3][i] != 0,
+                std::chrono::nanoseconds(columns[0][i])};
+    }
+};
+
+template<>
+struct TickColumns<FillRecord> {
+    static constexpr TickStreamKind kind = TickStreamKind::Fills;
+    static constexpr std::array<columnar::ColumnEncoding, 4> encodings{
+        columnar::ColumnEncoding::Delta,             // timestamp
+        columnar::ColumnEncoding::Delta,             // price
+        columnar::ColumnEncoding::FrameOfReference,  // quantity
+        columnar::ColumnEncoding::Delta,             // order_id
+    };
+
+    static double price(const FillRecord& fill) { return fill.price; }
+
+    static void split(const FillRecord& fill, int64_t price_scale, int64_t* row) {
+        row[0] = fill.timestamp.count();
+        row[1] = price_to_ticks(fill.price, price_scale);
+        row[2] = fill.quantity;
+        row[3] = static_cast<int64_t>(fill.order_id);
+    }
+
+    static FillRecord join(const int64_t* const* columns, int64_t price_scale, size_t i) {
+        return {static_cast<uint64_t>(columns[3][i]), ticks_to_price(columns[1][i], price_scale), columns[2][i],
+                std::chrono::nanoseconds(columns[0][i])};
+    }
+};
+
+// Record-type independent half of the writer: stages rows column-wise and
+// encodes a block each time block_size rows are staged
+class TickFileWriter {
+public:
+    TickFileWriter(const std::filesystem::path& path, TickStreamKind kind,
+                   std::span<const columnar::ColumnEncoding> encodings, size_t block_size, int64_t price_scale);
+    ~TickFileWriter();
+
+    TickFileWriter(const TickFileWriter&)            = delete;
+    TickFileWriter& operator=(const TickFileWriter&) = delete;
+
+    void push(const int64_t* row) {
+        for (size_t c = 0; c < columns_.size(); ++c) {
+            columns_[c][staged_] = row[c];
+        }
+        if (++staged_ == block_size_) {
+            flush_block();
+        }
+    }
+
+    // Writes the final partial block, the index and the header. Further
+    // pushes are invalid; the destructor closes if this was never called.
+    void close();
+
+    uint64_t records() const { return records_; }
+    uint64_t bytes() const { return bytes_; }
+    int64_t  price_scale() const { return header_.price_scale; }
+
+private:
+    void flush_block();
+    void write(const void* data, size_t size);
+
+    std::filesystem::path                     path_;
+    std::ofstream                             out_;
+    TickFileHeader                            header_;
+    std::vector<columnar::ColumnEncoding>     encodings_;
+    std::vector<std::vector<int64_t>>         columns_;
+    std::vector<uint64_t>                     encoded_;
+    std::vector<TickBlockIndex>               index_;
+    size_t                                    block_size_;
+    size_t                                    staged_  = 0;
+    uint64_t                                  records_ = 0;
+    uint64_t                                  bytes_   = 0;
+    bool                                      closed_  = false;
+};
+
+// Record-type independent half of the reader. Blocks are decoded straight
+// out of the mapping; nothing is copied except the decoded values.
+class TickFile {
+public:
+    // Throws std::runtime_error if the file is not a tick file of this kind
+    TickFile(const std::filesystem::path& path, TickStreamKind kind, size_t column_count);
+
+    uint64_t                        record_count() const { return header_.record_count; }
+    size_t                          block_size() const { return header_.block_size; }
+    int64_t                         price_scale() const { return header_.price_scale; }
+    std::span<const TickBlockIndex> blocks() const { return index_; }
+    size_t                          file_size() const { return file_.size(); }
+
+    // columns[c] must hold columnar::padded_count(block_size()) values
+    void decode_block(size_t block, int64_t* const* columns) const;
+
+    // Decodes a single column, skipping over the ones before it
+    void decode_column(size_t block, size_t column, int64_t* out) const;
+
+private:
+    // True if every column of the block ends before the index
+    bool block_fits(const TickBlockIndex& block) const;
+
+    const uint64_t* block_data(size_t block) const {
+        return reinterpret_cast<const uint64_t*>(file_.data() + index_[block].offset);
+    }
+
+    MappedFile                      file_;
+    TickFileHeader                  header_;
+    size_t                          column_count_;
+    std::span<const TickBlockIndex> index_;
+};
+
+template<typename R>
+class TickWriter {
+public:
+    using Columns = TickColumns<R>;
+
+    // Prices are stored as integer ticks of 1 / price_scale
+    explicit TickWriter(const std::filesystem::path& path, size_t block_size = kDefaultTickBlockSize,
+                        int64_t price_scale = protocol::kPriceScale)
+        : file_(path, Columns::kind, Columns::encodings, block_size, price_scale) {}
+
+    void append(const R& record) {
+        int64_t row[Columns::encodings.size()];
+        Columns::split(record, file_.price_scale(), row);
+        if (unlikely(ticks_to_price(row[1], file_.price_scale()) != Columns::price(record))) {
+            ++inexact_prices_;
+        }
+        file_.push(row);
+    }
+
+    void append(std::span<const R> records) {
+        for (const R& record : records) {
+            append(record);
+        }
+    }
+
+    void close() { file_.close(); }
+
+    uint64_t records() const { return file_.records(); }
+    uint64_t bytes() const { return file_.bytes(); }
+
+    // Records whose price was rounded to the tick grid and will read back
+    // differently; a non-zero count means price_scale is too coarse
+    uint64_t inexact_prices() const { return inexact_prices_; }
+
+private:
+    TickFileWriter file_;
+    uint64_t       inexact_prices_ = 0;
+};
+
+template<typename R>
+class TickReader {
+public:
+    using Columns = TickColumns<R>;
+    static constexpr size_t kColumnCount = Columns::encodings.size();
+
+    explicit TickReader(const std::filesystem::path& path) : file_(path, Columns::kind, kColumnCount) {
+        for (size_t c = 0; c < kColumnCount; ++c) {
+            scratch_[c].resize(columnar::padded_count(file_.block_size()));
+            columns_[c] = scratch_[c].data();
+        }
+    }
+
+    uint64_t                        record_count() const { return file_.record_count(); }
+    std::span<const TickBlockIndex> blocks() const { return file_.blocks(); }
+    size_t                          file_size() const { return file_.file_size(); }
+
+    // Appends every record of one block to out
+    void read_block(size_t block, std::vector<R>& out) {
+        file_.decode_block(block, columns_.data());
+        size_t count = file_.blocks()[block].count;
+        for (size_t i = 0; i < count; ++i) {
+            out.push_back(Columns::join(columns_.data(), file_.price_scale(), i));
+        }
+    }
+
+    std::vector<R> read_all() {
+        std::vector<R> out;
+        out.reserve(record_count());
+        for (size_t b = 0; b < file_.blocks().size(); ++b) {
+            read_block(b, out);
+        }
+        return out;
+    }
+
+    // Calls f for every record with from <= timestamp <= to. Blocks whose
+    // index range misses the window are never decoded. Returns the number
+    // of blocks that were.
+    template<typename F>
+    size_t scan(std::chrono::nanoseconds from, std::chrono::nanoseconds to, F&& f) {
+        size_t decoded = 0;
+        auto   blocks  = file_.blocks();
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            if (blocks[b].max_timestamp < from.count() || blocks[b].min_timestamp > to.count()) {
+                continue;
+            }
+            file_.decode_block(b, columns_.data());
+            ++decoded;
+            const int64_t* timestamps = columns_[0];
+            for (size_t i = 0; i < blocks[b].count; ++i) {
+                if (timestamps[i] >= from.count() && timestamps[i] <= to.count()) {
+                    f(Columns::join(columns_.data(), file_.price_scale(), i));
+                }
+            }
+        }
+        return decoded;
+    }
+
+    std::vector<R> query(std::chrono::nanoseconds from, std::chrono::nanoseconds to) {
+        std::vector<R> out;
+        scan(from, to, [&out](const R& record) { out.push_back(record); });
+        return out;
+    }
+
+    // Decoded values of one column of one block, valid until the next decode.
+    // Scanning a single field this way leaves the other columns untouched.
+    std::span<const int64_t> column(size_t block, size_t column) {
+        file_.decode_column(block, column, columns_[column]);
+        return {columns_[column], file_.blocks()[block].count};
+    }
+
+private:
+    TickFile                                    file_;
+    std::array<std::vector<int64_t>, kColumnCount> scratch_;
+    std::array<int64_t*, kColumnCount>          columns_{};
+};
+
+} // namespace hft
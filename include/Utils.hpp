@@ -3,6 +3,10 @@
 #include <chrono>
 #include <random>
 #include <atomic>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace hft::utils {
 
@@ -11,10 +15,15 @@ inline std::chrono::nanoseconds current_time() {
     return std::chrono::high_resolution_clock::now().time_since_epoch();
 }
 
+// Last order ID handed out, shared with the per-thread blocks in ThreadServices.hpp
+inline std::atomic<uint64_t>& order_id_counter() {
+    static std::atomic<uint64_t> next_id{0};
+    return next_id;
+}
+
 // Thread-safe unique ID generation
 inline uint64_t generate_order_id() {
-    static std::atomic<uint64_t> next_id{0};
-    return ++next_id;
+    return order_id_counter().fetch_add(1, std::memory_order_relaxed) + 1;
 }
 
 // Add likely/unlikely macros
@@ -31,4 +40,18 @@ inline void prefetch(const void* addr) {
     __builtin_prefetch(addr);
 }
 
+// Pin the calling thread to one core. Returns false where affinity isn't
+// supported (non-Linux) or the core doesn't exist.
+inline bool pin_current_thread(int cpu) {
+#ifdef __linux__
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
 } // namespace hft::utils 
\ No newline at end of file
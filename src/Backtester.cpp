@@ -0,0 +1,110 @@
+#include "Backtester.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace hft {
+
+BacktestContext::BacktestContext(Engine& engine) : engine_(engine) {
+    pending_fills_.reserve(16);
+}
+
+bool BacktestContext::submit(double price, int64_t quantity, bool is_buy) {
+    ++orders_;
+
+    // The engine fills whole orders, so send no more than the tape shows
+    TapeQuote& quote    = is_buy ? tape_ask_ : tape_bid_;
+    int64_t    tradable = std::min(quantity, quote.quantity);
+    if (tradable <= 0) {
+        return false;
+    }
+
+    uint64_t id     = next_strategy_id_++;
+    size_t   before = pending_fills_.size();
+    pending_is_buy_ = is_buy;
+    engine_.handle_order({
+        .id        = id,
+        .price     = price,
+        .quantity  = tradable,
+        .is_buy    = is_buy,
+        .timestamp = now_,
+    });
+    engine_.cancel_order(id);  // Whatever didn't trade doesn't rest
+    if (pending_fills_.size() == before) {
+        return false;
+    }
+
+    // Take the traded size off the quote so it can't be hit again
+    engine_.cancel_order(quote.id);
+    quote.id = 0;
+    quote.quantity -= tradable;
+    if (quote.quantity > 0) {
+        rest(quote, !is_buy);
+    }
+    return true;
+}
+
+void BacktestContext::on_tape_update(const RecordedUpdate& update) {
+    TapeQuote& quote = update.is_buy ? tape_bid_ : tape_ask_;
+    if (quote.id != 0) {
+        engine_.cancel_order(quote.id);
+        quote.id = 0;
+    }
+    quote.price    = update.price;
+    quote.quantity = std::max<int64_t>(update.quantity, 0);
+    if (quote.quantity > 0) {
+        rest(quote, update.is_buy);
+    }
+}
+
+void BacktestContext::rest(TapeQuote& quote, bool is_buy) {
+    quote.id = next_tape_id_++;
+    engine_.handle_order({
+        .id        = quote.id,
+        .price     = quote.price,
+        .quantity  = quote.quantity,
+        .is_buy    = is_buy,
+        .timestamp = now_,
+    });
+}
+
+void BacktestContext::on_engine_fill(uint64_t id, double price, int64_t quantity) {
+    if ((id & kStrategyIdBit) == 0) {
+        return;  // Tape quotes crossing each other
+    }
+    if (pending_is_buy_) {
+        position_ += quantity;
+        cash_ -= price * static_cast<double>(quantity);
+    } else {
+        position_ -= quantity;
+        cash_ += price * static_cast<double>(quantity);
+    }
+    ++fills_;
+    volume_ += quantity;
+    pending_fills_.push_back({price, quantity, pending_is_buy_, now_});
+}
+
+std::vector<SessionTask> discover_sessions(const std::filesystem::path& root) {
+    namespace fs = std::filesystem;
+    if (!fs::is_directory(root)) {
+        throw std::runtime_error("Session directory not found: " + root.string());
+    }
+
+    std::vector<SessionTask> tasks;
+    for (const auto& day : fs::directory_iterator(root)) {
+        if (!day.is_directory()) {
+            continue;
+        }
+        for (const auto& file : fs::directory_iterator(day.path())) {
+            if (file.is_regular_file() && file.path().extension() == ".bin") {
+                tasks.push_back({day.path().filename().string(), file.path().stem().string(), file.path(),
+                                 file.file_size()});
+            }
+        }
+    }
+    std::sort(tasks.begin(), tasks.end(), [](const SessionTask& a, const SessionTask& b) {
+        return a.day != b.day ? a.day < b.day : a.symbol < b.symbol;
+    });
+    return tasks;
+}
+
+} // namespace hft
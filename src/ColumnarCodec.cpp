@@ -0,0 +1,197 @@
+#include "ColumnarCodec.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace hft::columnar {
+
+namespace {
+
+inline uint64_t zigzag_encode(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t zigzag_decode(uint64_t v) {
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+}
+
+template<unsigned W>
+constexpr uint64_t width_mask() {
+    return W == 64 ? ~uint64_t{0} : (uint64_t{1} << W) - 1;
+}
+
+template<unsigned W>
+void pack_group(const uint64_t* in, uint64_t* out) {
+    std::memset(out, 0, kLanes * W * sizeof(uint64_t));
+    if constexpr (W > 0) {
+        for (unsigned k = 0; k < 64; ++k) {
+            unsigned bit  = k * W;
+            unsigned word = bit >> 6;
+            unsigned off  = bit & 63;
+            for (unsigned lane = 0; lane < kLanes; ++lane) {
+                uint64_t v = in[k * kLanes + lane] & width_mask<W>();
+                out[word * kLanes + lane] |= v << off;
+                if (off + W > 64) {
+                    out[(word + 1) * kLanes + lane] |= v >> (64 - off);
+                }
+            }
+        }
+    }
+}
+
+template<unsigned W>
+void unpack_group(const uint64_t* in, uint64_t* out) {
+    if constexpr (W == 0) {
+        std::memset(out, 0, kGroupSize * sizeof(uint64_t));
+    } else {
+#if defined(__AVX2__)
+        static_assert(kLanes == 4, "AVX2 kernel handles four 64-bit lanes per vector");
+        const __m256i mask = _mm256_set1_epi64x(static_cast<long long>(width_mask<W>()));
+#pragma GCC unroll 64
+        for (unsigned k = 0; k < 64; ++k) {
+            unsigned bit  = k * W;
+            unsigned word = bit >> 6;
+            unsigned off  = bit & 63;
+            __m256i  v    = _mm256_srli_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + word * 4)),
+                                              static_cast<int>(off));
+            if (off + W > 64) {
+                __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + (word + 1) * 4));
+                v          = _mm256_or_si256(v, _mm256_slli_epi64(hi, static_cast<int>(64 - off)));
+            }
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + k * 4), _mm256_and_si256(v, mask));
+        }
+#else
+        // Same shift for every lane at each step; compilers vectorise the lane loop
+#pragma GCC unroll 64
+        for (unsigned k = 0; k < 64; ++k) {
+            unsigned bit  = k * W;
+            unsigned word = bit >> 6;
+            unsigned off  = bit & 63;
+            for (unsigned lane = 0; lane < kLanes; ++lane) {
+                uint64_t v = in[word * kLanes + lane] >> off;
+                if (off + W > 64) {
+                    v |= in[(word + 1) * kLanes + lane] << (64 - off);
+                }
+                out[k * kLanes + lane] = v & width_mask<W>();
+            }
+        }
+#endif
+    }
+}
+
+using GroupKernel = void (*)(const uint64_t*, uint64_t*);
+
+template<size_t... W>
+constexpr std::array<GroupKernel, sizeof...(W)> make_pack_table(std::index_sequence<W...>) {
+    return {&pack_group<W>...};
+}
+
+template<size_t... W>
+constexpr std::array<GroupKernel, sizeof...(W)> make_unpack_table(std::index_sequence<W...>) {
+    return {&unpack_group<W>...};
+}
+
+constexpr auto kPackKernels   = make_pack_table(std::make_index_sequence<65>{});
+constexpr auto kUnpackKernels = make_unpack_table(std::make_index_sequence<65>{});
+
+struct ColumnHeader {
+    ColumnEncoding encoding;
+    unsigned       width;
+    int64_t        base;
+};
+
+ColumnHeader read_header(const uint64_t* in) {
+    ColumnHeader header{static_cast<ColumnEncoding>(in[0] & 0xff), static_cast<unsigned>((in[0] >> 8) & 0xff),
+                        static_cast<int64_t>(in[1])};
+    if (header.width > 64 || (header.encoding != ColumnEncoding::Delta &&
+                              header.encoding != ColumnEncoding::FrameOfReference)) {
+        throw std::runtime_error("Corrupt column header");
+    }
+    return header;
+}
+
+} // namespace
+
+void pack(const uint64_t* in, size_t groups, unsigned width, uint64_t* out) {
+    GroupKernel kernel = kPackKernels[width];
+    for (size_t g = 0; g < groups; ++g) {
+        kernel(in + g * kGroupSize, out + g * kLanes * width);
+    }
+}
+
+void unpack(const uint64_t* in, size_t groups, unsigned width, uint64_t* out) {
+    GroupKernel kernel = kUnpackKernels[width];
+    for (size_t g = 0; g < groups; ++g) {
+        kernel(in + g * kLanes * width, out + g * kGroupSize);
+    }
+}
+
+void encode_column(ColumnEncoding encoding, const int64_t* values, size_t count, std::vector<uint64_t>& out) {
+    std::vector<uint64_t> staged(padded_count(count), 0);
+    int64_t base = 0;
+
+    if (count > 0) {
+        if (encoding == ColumnEncoding::Delta) {
+            base = values[0];
+            for (size_t i = 1; i < count; ++i) {
+                // Wrapping subtraction: the decoder's wrapping add undoes it exactly
+                staged[i] = zigzag_encode(static_cast<int64_t>(static_cast<uint64_t>(values[i]) -
+                                                               static_cast<uint64_t>(values[i - 1])));
+            }
+        } else {
+            base = *std::min_element(values, values + count);
+            for (size_t i = 0; i < count; ++i) {
+                staged[i] = static_cast<uint64_t>(values[i]) - static_cast<uint64_t>(base);
+            }
+        }
+    }
+
+    uint64_t all_bits = 0;
+    for (uint64_t v : staged) {
+        all_bits |= v;
+    }
+    unsigned width = static_cast<unsigned>(std::bit_width(all_bits));
+
+    size_t start = out.size();
+    out.resize(start + encoded_words(count, width));
+    out[start]     = static_cast<uint64_t>(encoding) | (uint64_t{width} << 8);
+    out[start + 1] = static_cast<uint64_t>(base);
+    pack(staged.data(), staged.size() / kGroupSize, width, out.data() + start + 2);
+}
+
+const uint64_t* decode_column(const uint64_t* in, size_t count, int64_t* out) {
+    ColumnHeader header = read_header(in);
+    size_t       groups = padded_count(count) / kGroupSize;
+    auto*        raw    = reinterpret_cast<uint64_t*>(out);
+    unpack(in + 2, groups, header.width, raw);
+
+    uint64_t base = static_cast<uint64_t>(header.base);
+    if (header.encoding == ColumnEncoding::FrameOfReference) {
+        for (size_t i = 0; i < count; ++i) {
+            raw[i] += base;
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            raw[i] = static_cast<uint64_t>(zigzag_decode(raw[i]));
+        }
+        // The running sum is the one step that stays serial
+        uint64_t acc = base;
+        for (size_t i = 0; i < count; ++i) {
+            acc += raw[i];
+            raw[i] = acc;
+        }
+    }
+    return in + encoded_words(count, header.width);
+}
+
+const uint64_t* skip_column(const uint64_t* in, size_t count) {
+    return in + encoded_words(count, read_header(in).width);
+}
+
+} // namespace hft::columnar
@@ -0,0 +1,400 @@
+#include "MarketDataPublisher.hpp"
+#include "OrderProtocol.hpp"
+#include "SocketUtils.hpp"
+#include "Utils.hpp"
+#include <cstring>
+#include <poll.h>
+#include <unistd.h>
+
+namespace hft {
+
+using detail::make_address;
+using detail::throw_errno;
+
+MarketDataPublisher::MarketDataPublisher(PublisherConfig config)
+    : config_(std::move(config)), ring_(config_.ring_capacity), running_(false) {
+    if (config_.max_packet_size < sizeof(feed::PacketHeader) + sizeof(feed::LevelUpdate)) {
+        throw std::invalid_argument("max_packet_size too small for a single message");
+    }
+    packet_.reserve(config_.max_packet_size);
+    overflow_bids_.reserve(1024);
+    overflow_asks_.reserve(1024);
+}
+
+MarketDataPublisher::~MarketDataPublisher() {
+    detach();
+    stop();
+}
+
+void MarketDataPublisher::attach(Engine& engine) {
+    detach();
+    engine_ = &engine;
+    engine.set_level_callback([this](LevelAction action, bool is_buy, double price, int64_t quantity) {
+        on_level(action, is_buy, price, quantity);
+    });
+    engine.set_trade_callback([this](double price, int64_t quantity, bool aggressor_is_buy) {
+        on_trade(price, quantity, aggressor_is_buy);
+    });
+}
+
+void MarketDataPublisher::detach() {
+    if (engine_) {
+        engine_->set_level_callback(nullptr);
+        engine_->set_trade_callback(nullptr);
+        engine_ = nullptr;
+    }
+}
+
+void MarketDataPublisher::on_level(LevelAction action, bool is_buy, double price, int64_t quantity) {
+    EventKind kind = action == LevelAction::Add    ? EventKind::Add
+                   : action == LevelAction::Modify ? EventKind::Modify
+                                                   : EventKind::Delete;
+    push({kind, is_buy, protocol::to_ticks(price), quantity});
+}
+
+void MarketDataPublisher::on_trade(double price, int64_t quantity, bool aggressor_is_buy) {
+    push({EventKind::Trade, aggressor_is_buy, protocol::to_ticks(price), quantity});
+}
+
+void MarketDataPublisher::push(const BookEvent& event) {
+    while (producer_lock_.test_and_set(std::memory_order_acquire)) {
+    }
+    // stop() clears running_ under the lock, so nothing reaches the ring
+    // after the encoder's final drain
+    bool running = running_.load(std::memory_order_relaxed);
+    if (unlikely(!running || overflowed_.load(std::memory_order_relaxed) || !ring_.try_push(event))) {
+        // Never wait for the encoder: keep only each level's latest total
+        overflowed_.store(true, std::memory_order_relaxed);
+        if (running) {
+            ring_full_.fetch_add(1, std::memory_order_relaxed);
+        }
+        int64_t quantity = event.kind == EventKind::Delete ? 0 : event.quantity;
+        if (event.kind == EventKind::Trade) {
+            trades_dropped_.fetch_add(1, std::memory_order_relaxed);
+        } else if (event.is_buy) {
+            overflow_bids_[event.price] = quantity;
+        } else {
+            overflow_asks_[event.price] = quantity;
+        }
+    }
+    bool wake = running && sleeping_.load(std::memory_order_relaxed);
+    if (wake) {
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+    producer_lock_.clear(std::memory_order_release);
+
+    if (unlikely(wake)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_.notify_one();
+    }
+}
+
+void MarketDataPublisher::start() {
+    if (running_) {
+        return;
+    }
+
+    socket_fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_fd_ < 0) {
+        throw_errno("socket");
+    }
+    in_addr       interface = make_address(config_.interface, 0).sin_addr;
+    unsigned char ttl       = static_cast<unsigned char>(config_.ttl);
+    unsigned char loop      = 1;
+    if (::setsockopt(socket_fd_, IPPROTO_IP, IP_MULTICAST_IF, &interface, sizeof(interface)) < 0 ||
+        ::setsockopt(socket_fd_, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl)) < 0 ||
+        ::setsockopt(socket_fd_, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop)) < 0) {
+        throw_errno("setsockopt");
+    }
+    sockaddr_in destination = make_address(config_.group, config_.port);
+    if (::connect(socket_fd_, reinterpret_cast<sockaddr*>(&destination), sizeof(destination)) < 0) {
+        throw_errno("connect");
+    }
+
+    next_snapshot_ = std::chrono::steady_clock::now() + config_.snapshot_interval;
+    running_       = true;
+    worker_        = std::thread([this]() { run(); });
+}
+
+void MarketDataPublisher::stop() {
+    while (producer_lock_.test_and_set(std::memory_order_acquire)) {
+    }
+    running_.store(false, std::memory_order_release);
+    sleeping_.store(false, std::memory_order_relaxed);
+    producer_lock_.clear(std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_.notify_one();
+    }
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    if (socket_fd_ >= 0) {
+        ::close(socket_fd_);
+        socket_fd_ = -1;
+    }
+}
+
+MarketDataPublisher::Stats MarketDataPublisher::stats() const {
+    return {
+        .messages       = messages_.load(std::memory_order_relaxed),
+        .packets        = packets_.load(std::memory_order_relaxed),
+        .snapshots      = snapshots_.load(std::memory_order_relaxed),
+        .bytes          = bytes_.load(std::memory_order_relaxed),
+        .send_errors    = send_errors_.load(std::memory_order_relaxed),
+        .ring_full      = ring_full_.load(std::memory_order_relaxed),
+        .trades_dropped = trades_dropped_.load(std::memory_order_relaxed),
+    };
+}
+
+void MarketDataPublisher::run() {
+    if (config_.cpu >= 0) {
+        utils::pin_current_thread(config_.cpu);
+    }
+
+    BookEvent event;
+    size_t    idle = 0;
+    while (true) {
+        // Read running_ before draining so nothing pushed before stop() is lost.
+        // Level changes conflated while stopped are replayed by recover().
+        bool keep_running = running_.load(std::memory_order_acquire);
+
+        bool drained_any = false;
+        while (ring_.try_pop(event)) {
+            encode(event);
+            drained_any = true;
+        }
+        if (overflowed_.load(std::memory_order_acquire)) {
+            recover();
+            drained_any = true;
+        }
+        // Ring is empty: don't hold a partial packet back waiting for more
+        flush_packet();
+
+        if (std::chrono::steady_clock::now() >= next_snapshot_) {
+            publish_snapshot();
+            next_snapshot_ = std::chrono::steady_clock::now() + config_.snapshot_interval;
+        }
+
+        if (!keep_running) {
+            break;
+        }
+        if (drained_any) {
+            idle = 0;
+        } else if (config_.cpu < 0 && ++idle >= config_.idle_spins) {
+            wait_for_events();
+            idle = 0;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void MarketDataPublisher::wait_for_events() {
+    // Decide to sleep under the producer lock so a push can't slip in between
+    // the emptiness check and sleeping_ being set
+    while (producer_lock_.test_and_set(std::memory_order_acquire)) {
+    }
+    bool idle = ring_.empty() && !overflowed_.load(std::memory_order_relaxed) &&
+                running_.load(std::memory_order_relaxed);
+    sleeping_.store(idle, std::memory_order_relaxed);
+    producer_lock_.clear(std::memory_order_release);
+    if (!idle) {
+        return;
+    }
+
+    // Wake for the next snapshot even if nothing arrives
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.wait_until(lock, next_snapshot_, [this] { return !sleeping_.load(std::memory_order_relaxed); });
+    sleeping_.store(false, std::memory_order_relaxed);
+}
+
+void MarketDataPublisher::encode(const BookEvent& event) {
+    using feed::MessageType;
+
+    if (event.kind == EventKind::Trade) {
+        auto msg          = feed::make_message<feed::Trade>(MessageType::Trade);
+        msg.header.is_buy = event.is_buy;
+        msg.price         = event.price;
+        msg.quantity      = event.quantity;
+        append(msg);
+        return;
+    }
+
+    MessageType type = event.kind == EventKind::Add    ? MessageType::LevelAdd
+                     : event.kind == EventKind::Modify ? MessageType::LevelModify
+                                                       : MessageType::LevelDelete;
+    if (event.is_buy) {
+        if (event.kind == EventKind::Delete) {
+            bids_.erase(event.price);
+        } else {
+            bids_[event.price] = event.quantity;
+        }
+    } else {
+        if (event.kind == EventKind::Delete) {
+            asks_.erase(event.price);
+        } else {
+            asks_[event.price] = event.quantity;
+        }
+    }
+
+    auto msg          = feed::make_message<feed::LevelUpdate>(type);
+    msg.header.is_buy = event.is_buy;
+    msg.price         = event.price;
+    msg.quantity      = event.quantity;
+    append(msg);
+}
+
+void MarketDataPublisher::recover() {
+    // Producers divert everything while overflowed_ is set, so whatever is
+    // still in the ring predates the conflated levels; encode it first.
+    // The ring then stays empty and swapping the maps is all the lock covers.
+    BookEvent event;
+    while (ring_.try_pop(event)) {
+        encode(event);
+    }
+
+    while (producer_lock_.test_and_set(std::memory_order_acquire)) {
+    }
+    recovered_bids_.swap(overflow_bids_);
+    recovered_asks_.swap(overflow_asks_);
+    overflowed_.store(false, std::memory_order_relaxed);
+    producer_lock_.clear(std::memory_order_release);
+
+    auto replay = [this](const auto& conflated, const auto& shadow, bool is_buy) {
+        for (const auto& [price, quantity] : conflated) {
+            bool known = shadow.contains(price);
+            if (quantity == 0 && !known) {
+                continue;  // Came and went while we weren't looking
+            }
+            EventKind kind = quantity == 0 ? EventKind::Delete : known ? EventKind::Modify : EventKind::Add;
+            encode({kind, is_buy, price, quantity});
+        }
+    };
+    replay(recovered_bids_, bids_, true);
+    replay(recovered_asks_, asks_, false);
+    recovered_bids_.clear();
+    recovered_asks_.clear();
+
+    // Trades may have been lost; give receivers a clean reference point
+    publish_snapshot();
+    next_snapshot_ = std::chrono::steady_clock::now() + config_.snapshot_interval;
+}
+
+void MarketDataPublisher::publish_snapshot() {
+    using feed::MessageType;
+
+    // Start on a fresh packet so the snapshot isn't split from its begin marker
+    flush_packet();
+
+    auto begin        = feed::make_message<feed::SnapshotBegin>(MessageType::SnapshotBegin);
+    begin.level_count = static_cast<uint32_t>(bids_.size() + asks_.size());
+    append(begin);
+
+    auto level          = feed::make_message<feed::LevelUpdate>(MessageType::SnapshotLevel);
+    level.header.is_buy = 1;
+    for (const auto& [price, quantity] : bids_) {
+        level.price    = price;
+        level.quantity = quantity;
+        append(level);
+    }
+    level.header.is_buy = 0;
+    for (const auto& [price, quantity] : asks_) {
+        level.price    = price;
+        level.quantity = quantity;
+        append(level);
+    }
+
+    append(feed::make_message<feed::SnapshotEnd>(MessageType::SnapshotEnd));
+    flush_packet();
+    snapshots_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename Msg>
+void MarketDataPublisher::append(const Msg& msg) {
+    if (packet_.size() + sizeof(Msg) > config_.max_packet_size) {
+        flush_packet();
+    }
+    if (packet_.empty()) {
+        packet_.resize(sizeof(feed::PacketHeader));
+        packet_messages_ = 0;
+    }
+    auto* bytes = reinterpret_cast<const char*>(&msg);
+    packet_.insert(packet_.end(), bytes, bytes + sizeof(Msg));
+    ++packet_messages_;
+}
+
+void MarketDataPublisher::flush_packet() {
+    if (packet_messages_ == 0) {
+        return;
+    }
+
+    feed::PacketHeader header{};
+    header.sequence      = next_sequence_;
+    header.message_count = packet_messages_;
+    header.length        = static_cast<uint16_t>(packet_.size());
+    header.send_time     = static_cast<uint64_t>(utils::current_time().count());
+    std::memcpy(packet_.data(), &header, sizeof(header));
+
+    if (::send(socket_fd_, packet_.data(), packet_.size(), 0) < 0) {
+        send_errors_.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        packets_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(packet_.size(), std::memory_order_relaxed);
+    }
+    // Sequence numbers advance even if the send failed; receivers see the gap
+    next_sequence_ += packet_messages_;
+    messages_.fetch_add(packet_messages_, std::memory_order_relaxed);
+
+    packet_.clear();
+    packet_messages_ = 0;
+}
+
+// MarketDataReceiver
+
+MarketDataReceiver::~MarketDataReceiver() {
+    close();
+}
+
+void MarketDataReceiver::open(const std::string& group, uint16_t port, const std::string& interface) {
+    close();
+    fd_ = ::socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd_ < 0) {
+        throw_errno("socket");
+    }
+    int one = 1;
+    ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr = make_address("0.0.0.0", port);
+    if (::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        throw_errno("bind");
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+
+    ip_mreq membership{};
+    membership.imr_multiaddr = make_address(group, 0).sin_addr;
+    membership.imr_interface = make_address(interface, 0).sin_addr;
+    if (::setsockopt(fd_, IPPROTO_IP, IP_ADD_MEMBERSHIP, &membership, sizeof(membership)) < 0) {
+        throw_errno("IP_ADD_MEMBERSHIP");
+    }
+}
+
+void MarketDataReceiver::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+}
+
+size_t MarketDataReceiver::receive(char* buffer, size_t capacity, std::chrono::milliseconds timeout) {
+    pollfd pfd{fd_, POLLIN, 0};
+    if (::poll(&pfd, 1, static_cast<int>(timeout.count())) <= 0) {
+        return 0;
+    }
+    ssize_t n = ::recv(fd_, buffer, capacity, 0);
+    return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+} // namespace hft
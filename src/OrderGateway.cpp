@@ -0,0 +1,607 @@
+#include "OrderGateway.hpp"
+#include "SocketUtils.hpp"
+#include "ThreadServices.hpp"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace hft {
+
+using detail::make_address;
+using detail::set_nodelay;
+using detail::set_nonblocking;
+using detail::throw_errno;
+
+struct OrderGateway::Session {
+    int               fd;
+    std::vector<char> in;
+    size_t            in_parsed = 0;  // Bytes already framed into the current batch
+    size_t            in_tail   = 0;
+    std::vector<char> out;
+    size_t            out_head      = 0;
+    bool              active        = false;  // Listed in active_ this iteration
+    bool              closing       = false;
+    bool              want_writable = false;
+
+    struct LiveOrder {
+        uint64_t order_id;
+        bool     is_buy;
+    };
+
+    // Client order id -> engine order for this session's live orders
+    std::unordered_map<uint64_t, LiveOrder> live_orders;
+
+    Session(int socket_fd, size_t buffer_size) : fd(socket_fd), in(buffer_size) {
+        out.reserve(buffer_size);
+    }
+};
+
+OrderGateway::OrderGateway(Engine& engine, GatewayConfig config)
+    : engine_(engine), config_(std::move(config)), running_(false) {
+    batch_.reserve(config_.max_events * 16);
+    active_.reserve(config_.max_events);
+    pending_fills_.reserve(64);
+    orders_.reserve(1 << 16);
+}
+
+OrderGateway::~OrderGateway() {
+    stop();
+}
+
+void OrderGateway::start() {
+    if (running_) {
+        return;
+    }
+
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd_ < 0) {
+        throw_errno("socket");
+    }
+    int one = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    sockaddr_in addr = make_address(config_.bind_address, config_.port);
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        throw_errno("bind");
+    }
+    if (::listen(listen_fd_, config_.listen_backlog) < 0) {
+        throw_errno("listen");
+    }
+    socklen_t len = sizeof(addr);
+    ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len);
+    port_ = ntohs(addr.sin_port);
+    set_nonblocking(listen_fd_);
+
+    epoll_fd_ = ::epoll_create1(0);
+    if (epoll_fd_ < 0) {
+        throw_errno("epoll_create1");
+    }
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK);
+    if (wake_fd_ < 0) {
+        throw_errno("eventfd");
+    }
+
+    epoll_event ev{};
+    ev.events  = EPOLLIN;
+    ev.data.fd = listen_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.fd = wake_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    previous_fill_callback_ = engine_.fill_callback();
+    engine_.set_fill_callback([this](const uint64_t& id, double price, int64_t quantity) {
+        pending_fills_.push_back({id, price, quantity});
+    });
+
+    utils::calibrate_clock();
+    running_ = true;
+    worker_  = std::thread([this]() { run(); });
+}
+
+void OrderGateway::stop() {
+    bool was_running = running_.exchange(false);
+    if (was_running) {
+        uint64_t one = 1;
+        [[maybe_unused]] auto n = ::write(wake_fd_, &one, sizeof(one));
+    }
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+    if (was_running) {
+        // The worker was the only caller into the engine; hand back whatever it had before
+        engine_.set_fill_callback(std::move(previous_fill_callback_));
+        previous_fill_callback_ = nullptr;
+    }
+
+    while (!sessions_.empty()) {
+        close_session(*sessions_.begin()->second);
+    }
+    for (int* fd : {&listen_fd_, &epoll_fd_, &wake_fd_}) {
+        if (*fd >= 0) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+OrderGateway::Stats OrderGateway::stats() const {
+    return {
+        .messages_in   = messages_in_.load(std::memory_order_relaxed),
+        .messages_out  = messages_out_.load(std::memory_order_relaxed),
+        .rejects       = rejects_.load(std::memory_order_relaxed),
+        .socket_writes = socket_writes_.load(std::memory_order_relaxed),
+        .batches       = batches_.load(std::memory_order_relaxed),
+        .connections   = connections_.load(std::memory_order_relaxed),
+    };
+}
+
+void OrderGateway::run() {
+    if (config_.cpu >= 0) {
+        utils::pin_current_thread(config_.cpu);
+    }
+
+    std::vector<epoll_event> events(config_.max_events);
+    utils::thread_time();  // Anchor this thread's clock before the first batch
+
+    while (running_) {
+        int n = ::epoll_wait(epoll_fd_, events.data(), config_.max_events, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        // Phase 1: read and frame
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd_) {
+                continue;
+            }
+            if (fd == listen_fd_) {
+                accept_connections();
+                continue;
+            }
+            auto it = sessions_.find(fd);
+            if (it == sessions_.end()) {
+                continue;
+            }
+            Session& session = *it->second;
+            if (!session.active) {
+                session.active = true;
+                active_.push_back(&session);
+            }
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                session.closing = true;
+            }
+            if (events[i].events & EPOLLIN) {
+                read_session(session);
+            }
+        }
+
+        // Phase 2: submit
+        if (!batch_.empty()) {
+            submit_batch();
+        }
+
+        // Phase 3: coalesced writes, buffer compaction and teardown
+        for (Session* session : active_) {
+            session->active = false;
+            flush(*session);  // Best effort for closing sessions so a final reject still goes out
+            size_t remaining = session->in_tail - session->in_parsed;
+            if (remaining > 0 && session->in_parsed > 0) {
+                std::memmove(session->in.data(), session->in.data() + session->in_parsed, remaining);
+            }
+            session->in_tail   = remaining;
+            session->in_parsed = 0;
+            if (session->closing) {
+                close_session(*session);
+            }
+        }
+        active_.clear();
+    }
+}
+
+void OrderGateway::accept_connections() {
+    while (true) {
+        int fd = ::accept(listen_fd_, nullptr, nullptr);
+        if (fd < 0) {
+            return;  // EAGAIN or a transient accept failure; epoll will report again
+        }
+        try {
+            set_nonblocking(fd);
+            set_nodelay(fd);
+        } catch (const std::exception&) {
+            ::close(fd);
+            continue;
+        }
+
+        auto session = std::make_unique<Session>(fd, config_.recv_buffer_size);
+        epoll_event ev{};
+        ev.events  = EPOLLIN;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+        sessions_.emplace(fd, std::move(session));
+        connections_.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void OrderGateway::read_session(Session& session) {
+    size_t space = session.in.size() - session.in_tail;
+    if (space == 0) {
+        return;  // Buffer full of framed-but-unsubmitted data; level triggering brings us back
+    }
+
+    ssize_t n = ::recv(session.fd, session.in.data() + session.in_tail, space, 0);
+    if (n == 0) {
+        session.closing = true;
+        return;
+    }
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            session.closing = true;
+        }
+        return;
+    }
+    session.in_tail += static_cast<size_t>(n);
+
+    while (true) {
+        auto result = protocol::decode(session.in.data() + session.in_parsed, session.in_tail - session.in_parsed);
+        if (result.status == protocol::DecodeStatus::Incomplete) {
+            break;
+        }
+        if (result.status == protocol::DecodeStatus::Malformed) {
+            send_reject(session, result.header->type, protocol::RejectReason::Malformed, 0, 0);
+            session.closing   = true;
+            session.in_parsed = session.in_tail;
+            break;
+        }
+        batch_.push_back({&session, result.header});
+        session.in_parsed += result.header->length;
+    }
+}
+
+void OrderGateway::submit_batch() {
+    using protocol::MessageType;
+
+    messages_in_.fetch_add(batch_.size(), std::memory_order_relaxed);
+    batches_.fetch_add(1, std::memory_order_relaxed);
+    batch_time_ = utils::thread_time();  // Everything read in one wakeup arrived together
+
+    for (const Command& cmd : batch_) {
+        Session& session = *cmd.session;
+        switch (cmd.header->type) {
+            case MessageType::NewOrder:
+                handle_new_order(session, protocol::message_cast<protocol::NewOrder>(cmd.header));
+                break;
+            case MessageType::CancelOrder:
+                handle_cancel(session, protocol::message_cast<protocol::CancelOrder>(cmd.header));
+                break;
+            case MessageType::ReplaceOrder:
+                handle_replace(session, protocol::message_cast<protocol::ReplaceOrder>(cmd.header));
+                break;
+            default:
+                send_reject(session, cmd.header->type, protocol::RejectReason::Malformed, 0, 0);
+                break;
+        }
+    }
+    batch_.clear();
+}
+
+void OrderGateway::handle_new_order(Session& session, const protocol::NewOrder& msg) {
+    if (session.live_orders.contains(msg.client_order_id)) {
+        send_reject(session, protocol::MessageType::NewOrder, protocol::RejectReason::DuplicateId,
+                    msg.client_order_id, msg.client_timestamp);
+        return;
+    }
+
+    if (!valid_order(msg.price, msg.quantity) || msg.is_buy > 1) {
+        send_reject(session, protocol::MessageType::NewOrder, protocol::RejectReason::Malformed,
+                    msg.client_order_id, msg.client_timestamp);
+        return;
+    }
+
+    uint64_t order_id = 0;
+    if (!submit_to_engine(session, msg.client_order_id, protocol::from_ticks(msg.price), msg.quantity, msg.is_buy != 0,
+                          order_id)) {
+        send_reject(session, protocol::MessageType::NewOrder, protocol::RejectReason::EngineError,
+                    msg.client_order_id, msg.client_timestamp);
+        return;
+    }
+    send_ack(session, protocol::MessageType::NewOrder, msg.client_order_id, order_id, msg.client_timestamp);
+    drain_fills();
+}
+
+void OrderGateway::handle_cancel(Session& session, const protocol::CancelOrder& msg) {
+    if (!session.live_orders.contains(msg.client_order_id)) {
+        send_reject(session, protocol::MessageType::CancelOrder, protocol::RejectReason::UnknownOrder,
+                    msg.client_order_id, msg.client_timestamp);
+        return;
+    }
+    if (!cancel_in_engine(session, msg.client_order_id)) {
+        send_reject(session, protocol::MessageType::CancelOrder, protocol::RejectReason::EngineError,
+                    msg.client_order_id, msg.client_timestamp);
+        return;
+    }
+    send_ack(session, protocol::MessageType::CancelOrder, msg.client_order_id, 0, msg.client_timestamp);
+}
+
+void OrderGateway::handle_replace(Session& session, const protocol::ReplaceOrder& msg) {
+    auto it = session.live_orders.find(msg.orig_client_order_id);
+    if (it == session.live_orders.end()) {
+        send_reject(session, protocol::MessageType::ReplaceOrder, protocol::RejectReason::UnknownOrder,
+                    msg.client_order_id, msg.client_timestamp);
+        return;
+    }
+    if (msg.client_order_id != msg.orig_client_order_id && session.live_orders.contains(msg.client_order_id)) {
+        send_reject(session, protocol::MessageType::ReplaceOrder, protocol::RejectReason::DuplicateId,
+                    msg.client_order_id, msg.client_timestamp);
+        return;
+    }
+
+    // Checked before the cancel so a bad replace leaves the original resting
+    if (!valid_order(msg.price, msg.quantity)) {
+        send_reject(session, protocol::MessageType::ReplaceOrder, protocol::RejectReason::Malformed,
+                    msg.client_order_id, msg.client_timestamp);
+        return;
+    }
+
+    // The engine has no in-place replace, so this is cancel + new and the
+    // replacement loses time priority
+    bool     is_buy   = it->second.is_buy;
+    uint64_t order_id = 0;
+    if (!cancel_in_engine(session, msg.orig_client_order_id)) {
+        send_reject(session, protocol::MessageType::ReplaceOrder, protocol::RejectReason::EngineError,
+                    msg.client_order_id, msg.client_timestamp);
+        return;
+    }
+    if (!submit_to_engine(session, msg.client_order_id, protocol::from_ticks(msg.price), msg.quantity, is_buy,
+                          order_id)) {
+        // The original is gone either way; tell the client before rejecting the new one
+        send_ack(session, protocol::MessageType::CancelOrder, msg.orig_client_order_id, 0, msg.client_timestamp);
+        send_reject(session, protocol::MessageType::ReplaceOrder, protocol::RejectReason::EngineError,
+                    msg.client_order_id, msg.client_timestamp);
+        return;
+    }
+    send_ack(session, protocol::MessageType::ReplaceOrder, msg.client_order_id, order_id, msg.client_timestamp);
+    drain_fills();
+}
+
+bool OrderGateway::submit_to_engine(Session& session, uint64_t client_order_id, double price, int64_t quantity,
+                                    bool is_buy, uint64_t& order_id) {
+    order_id = utils::thread_order_id();
+    try {
+        engine_.handle_order({
+            .id        = order_id,
+            .price     = price,
+            .quantity  = quantity,
+            .is_buy    = is_buy,
+            .timestamp = batch_time_,
+        });
+    } catch (const std::exception&) {
+        pending_fills_.clear();
+        return false;
+    }
+    session.live_orders.emplace(client_order_id, Session::LiveOrder{order_id, is_buy});
+    orders_.emplace(order_id, OrderRef{&session, client_order_id});
+    return true;
+}
+
+bool OrderGateway::cancel_in_engine(Session& session, uint64_t client_order_id) {
+    auto     it       = session.live_orders.find(client_order_id);
+    uint64_t order_id = it->second.order_id;
+    session.live_orders.erase(it);
+    orders_.erase(order_id);
+    try {
+        engine_.cancel_order(order_id);
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+void OrderGateway::drain_fills() {
+    for (const PendingFill& fill : pending_fills_) {
+        auto it = orders_.find(fill.order_id);
+        if (it == orders_.end()) {
+            continue;
+        }
+        auto msg            = protocol::make_message<protocol::Fill>();
+        msg.client_order_id = it->second.client_order_id;
+        msg.order_id        = fill.order_id;
+        msg.price           = protocol::to_ticks(fill.price);
+        msg.quantity        = static_cast<uint32_t>(fill.quantity);
+        enqueue(*it->second.session, msg);
+    }
+    pending_fills_.clear();
+}
+
+void OrderGateway::send_ack(Session& session, protocol::MessageType type, uint64_t client_order_id,
+                            uint64_t order_id, uint64_t client_timestamp) {
+    auto msg             = protocol::make_message<protocol::Ack>();
+    msg.acked_type       = type;
+    msg.client_order_id  = client_order_id;
+    msg.order_id         = order_id;
+    msg.client_timestamp = client_timestamp;
+    enqueue(session, msg);
+}
+
+void OrderGateway::send_reject(Session& session, protocol::MessageType type, protocol::RejectReason reason,
+                               uint64_t client_order_id, uint64_t client_timestamp) {
+    auto msg             = protocol::make_message<protocol::Reject>();
+    msg.rejected_type    = type;
+    msg.reason           = reason;
+    msg.client_order_id  = client_order_id;
+    msg.client_timestamp = client_timestamp;
+    enqueue(session, msg);
+    rejects_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<typename Msg>
+void OrderGateway::enqueue(Session& session, const Msg& msg) {
+    if (!session.active) {
+        session.active = true;
+        active_.push_back(&session);
+    }
+    if (session.out.size() - session.out_head + sizeof(Msg) > config_.max_pending_out) {
+        // A reader this far behind is disconnected rather than buffered for
+        session.closing = true;
+        return;
+    }
+    auto* bytes = reinterpret_cast<const char*>(&msg);
+    session.out.insert(session.out.end(), bytes, bytes + sizeof(Msg));
+    messages_out_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void OrderGateway::flush(Session& session) {
+    size_t pending = session.out.size() - session.out_head;
+    if (pending > 0) {
+        ssize_t n = ::send(session.fd, session.out.data() + session.out_head, pending, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                session.closing = true;
+                return;
+            }
+            n = 0;
+        } else {
+            socket_writes_.fetch_add(1, std::memory_order_relaxed);
+        }
+        session.out_head += static_cast<size_t>(n);
+        if (session.out_head == session.out.size()) {
+            session.out.clear();
+            session.out_head = 0;
+        }
+    }
+
+    bool want_writable = session.out_head < session.out.size();
+    if (want_writable != session.want_writable) {
+        epoll_event ev{};
+        ev.events  = EPOLLIN | (want_writable ? EPOLLOUT : 0u);
+        ev.data.fd = session.fd;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, session.fd, &ev);
+        session.want_writable = want_writable;
+    }
+}
+
+void OrderGateway::close_session(Session& session) {
+    // Cancel-on-disconnect: nothing in the book may outlive its owner
+    for (const auto& [client_order_id, live] : session.live_orders) {
+        orders_.erase(live.order_id);
+        try {
+            engine_.cancel_order(live.order_id);
+        } catch (const std::exception&) {
+        }
+    }
+    int fd = session.fd;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    sessions_.erase(fd);
+}
+
+// OrderGatewayClient
+
+OrderGatewayClient::OrderGatewayClient() : buffer_(64 * 1024) {}
+
+OrderGatewayClient::~OrderGatewayClient() {
+    close();
+}
+
+void OrderGatewayClient::connect(const std::string& host, uint16_t port) {
+    close();
+    fd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd_ < 0) {
+        throw_errno("socket");
+    }
+    sockaddr_in addr = make_address(host, port);
+    if (::connect(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        throw_errno("connect");
+    }
+    set_nodelay(fd_);
+}
+
+void OrderGatewayClient::close() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+        fd_ = -1;
+    }
+    head_ = tail_ = 0;
+}
+
+void OrderGatewayClient::send_new_order(uint64_t client_order_id, double price, uint32_t quantity, bool is_buy,
+                                        uint64_t client_timestamp) {
+    auto msg             = protocol::make_message<protocol::NewOrder>();
+    msg.client_order_id  = client_order_id;
+    msg.price            = protocol::to_ticks(price);
+    msg.quantity         = quantity;
+    msg.is_buy           = is_buy ? 1 : 0;
+    msg.client_timestamp = client_timestamp;
+    send(msg);
+}
+
+void OrderGatewayClient::send_cancel(uint64_t client_order_id, uint64_t client_timestamp) {
+    auto msg             = protocol::make_message<protocol::CancelOrder>();
+    msg.client_order_id  = client_order_id;
+    msg.client_timestamp = client_timestamp;
+    send(msg);
+}
+
+void OrderGatewayClient::send_replace(uint64_t orig_client_order_id, uint64_t client_order_id, double price,
+                                      uint32_t quantity, uint64_t client_timestamp) {
+    auto msg                 = protocol::make_message<protocol::ReplaceOrder>();
+    msg.orig_client_order_id = orig_client_order_id;
+    msg.client_order_id      = client_order_id;
+    msg.price                = protocol::to_ticks(price);
+    msg.quantity             = quantity;
+    msg.client_timestamp     = client_timestamp;
+    send(msg);
+}
+
+void OrderGatewayClient::send_raw(const void* data, size_t size) {
+    auto* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t n = ::send(fd_, bytes, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("send");
+        }
+        bytes += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+const protocol::MessageHeader& OrderGatewayClient::receive() {
+    while (true) {
+        auto result = protocol::decode(buffer_.data() + head_, tail_ - head_);
+        if (result.status == protocol::DecodeStatus::Ok) {
+            head_ += result.header->length;
+            return *result.header;
+        }
+        if (result.status == protocol::DecodeStatus::Malformed) {
+            throw std::runtime_error("Malformed message from gateway");
+        }
+
+        if (head_ > 0) {
+            std::memmove(buffer_.data(), buffer_.data() + head_, tail_ - head_);
+            tail_ -= head_;
+            head_ = 0;
+        }
+        ssize_t n = ::recv(fd_, buffer_.data() + tail_, buffer_.size() - tail_, 0);
+        if (n == 0) {
+            throw std::runtime_error("Gateway closed the connection");
+        }
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("recv");
+        }
+        tail_ += static_cast<size_t>(n);
+    }
+}
+
+} // namespace hft
@@ -0,0 +1,59 @@
+#include "SessionFile.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace hft {
+
+void write_session_file(const std::filesystem::path& path, std::span<const RecordedUpdate> updates) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open " + path.string() + " for writing");
+    }
+    SessionFileHeader header{{'H', 'F', 'T', 'S'}, kSessionFileVersion, updates.size()};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Records are read in place, so they keep the in-memory layout, but the
+    // padding after is_buy is whatever the caller's memory held. Copy field
+    // by field into a zeroed staging buffer so no stray bytes reach the file.
+    constexpr size_t            kChunk = 4096;
+    std::vector<RecordedUpdate> staging(std::min(updates.size(), kChunk));
+    for (size_t begin = 0; begin < updates.size(); begin += kChunk) {
+        size_t count = std::min(kChunk, updates.size() - begin);
+        std::memset(static_cast<void*>(staging.data()), 0, count * sizeof(RecordedUpdate));
+        for (size_t i = 0; i < count; ++i) {
+            const RecordedUpdate& update = updates[begin + i];
+            staging[i].price             = update.price;
+            staging[i].quantity          = update.quantity;
+            staging[i].is_buy            = update.is_buy;
+            staging[i].timestamp         = update.timestamp;
+        }
+        out.write(reinterpret_cast<const char*>(staging.data()),
+                  static_cast<std::streamsize>(count * sizeof(RecordedUpdate)));
+    }
+    if (!out) {
+        throw std::runtime_error("Failed writing " + path.string());
+    }
+}
+
+SessionReader::SessionReader(const std::filesystem::path& path) : file_(path) {
+    SessionFileHeader header;
+    if (file_.size() < sizeof(header)) {
+        throw std::runtime_error("Truncated session file " + path.string());
+    }
+    std::memcpy(&header, file_.data(), sizeof(header));
+    if (std::memcmp(header.magic, "HFTS", 4) != 0 || header.version != kSessionFileVersion) {
+        throw std::runtime_error("Not a session file " + path.string());
+    }
+    // Divide rather than multiply: a corrupt count must not wrap past the check
+    if (header.record_count > (file_.size() - sizeof(header)) / sizeof(RecordedUpdate)) {
+        throw std::runtime_error("Truncated session file " + path.string());
+    }
+    // The mapping is page aligned and the header is 16 bytes, so records stay aligned
+    updates_ = {reinterpret_cast<const RecordedUpdate*>(file_.data() + sizeof(header)),
+                static_cast<size_t>(header.record_count)};
+}
+
+} // namespace hft
@@ -0,0 +1,164 @@
+#include "TickStore.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace hft {
+
+TickFileWriter::TickFileWriter(const std::filesystem::path& path, TickStreamKind kind,
+                               std::span<const columnar::ColumnEncoding> encodings, size_t block_size,
+                               int64_t price_scale)
+    : path_(path), out_(path, std::ios::binary | std::ios::trunc), header_{},
+      encodings_(encodings.begin(), encodings.end()), block_size_(block_size) {
+    if (!out_) {
+        throw std::runtime_error("Cannot open " + path.string() + " for writing");
+    }
+    if (block_size == 0 || block_size > UINT32_MAX || encodings.size() < 2 || price_scale <= 0) {
+        throw std::invalid_argument("Invalid tick file layout");
+    }
+    std::memcpy(header_.magic, "HFTC", 4);
+    header_.version     = kTickFileVersion;
+    header_.kind        = static_cast<uint32_t>(kind);
+    header_.block_size  = static_cast<uint32_t>(block_size);
+    header_.price_scale = price_scale;
+
+    columns_.assign(encodings_.size(), std::vector<int64_t>(block_size));
+    // Placeholder until close() knows the counts
+    write(&header_, sizeof(header_));
+}
+
+TickFileWriter::~TickFileWriter() {
+    if (!closed_) {
+        try {
+            close();
+        } catch (...) {
+        }
+    }
+}
+
+void TickFileWriter::close() {
+    if (closed_) {
+        return;
+    }
+    closed_ = true;
+    flush_block();
+
+    header_.record_count = records_;
+    header_.block_count  = index_.size();
+    header_.index_offset = bytes_;
+    write(index_.data(), index_.size() * sizeof(TickBlockIndex));
+
+    out_.seekp(0);
+    out_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    out_.close();
+    if (!out_) {
+        throw std::runtime_error("Failed writing " + path_.string());
+    }
+}
+
+void TickFileWriter::flush_block() {
+    if (staged_ == 0) {
+        return;
+    }
+
+    TickBlockIndex entry{};
+    entry.offset = bytes_;
+    entry.count  = static_cast<uint32_t>(staged_);
+    auto [min_ts, max_ts]       = std::minmax_element(columns_[0].begin(), columns_[0].begin() + staged_);
+    auto [min_price, max_price] = std::minmax_element(columns_[1].begin(), columns_[1].begin() + staged_);
+    entry.min_timestamp = *min_ts;
+    entry.max_timestamp = *max_ts;
+    entry.min_price     = *min_price;
+    entry.max_price     = *max_price;
+
+    encoded_.clear();
+    for (size_t c = 0; c < columns_.size(); ++c) {
+        columnar::encode_column(encodings_[c], columns_[c].data(), staged_, encoded_);
+    }
+    write(encoded_.data(), encoded_.size() * sizeof(uint64_t));
+
+    index_.push_back(entry);
+    records_ += staged_;
+    staged_ = 0;
+}
+
+void TickFileWriter::write(const void* data, size_t size) {
+    out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    if (!out_) {
+        throw std::runtime_error("Failed writing " + path_.string());
+    }
+    bytes_ += size;
+}
+
+TickFile::TickFile(const std::filesystem::path& path, TickStreamKind kind, size_t column_count)
+    : file_(path), column_count_(column_count) {
+    if (file_.size() < sizeof(header_)) {
+        throw std::runtime_error("Truncated tick file " + path.string());
+    }
+    std::memcpy(&header_, file_.data(), sizeof(header_));
+    if (std::memcmp(header_.magic, "HFTC", 4) != 0 || header_.version != kTickFileVersion) {
+        throw std::runtime_error("Not a tick file " + path.string());
+    }
+    if (header_.kind != static_cast<uint32_t>(kind) || header_.price_scale <= 0) {
+        throw std::runtime_error("Unexpected tick stream kind in " + path.string());
+    }
+    if (header_.index_offset > file_.size() ||
+        (file_.size() - header_.index_offset) / sizeof(TickBlockIndex) < header_.block_count) {
+        throw std::runtime_error("Truncated tick file " + path.string());
+    }
+    // The mapping is page aligned, so the index and every block must start on
+    // a word boundary to be read in place
+    if (header_.index_offset % sizeof(uint64_t) != 0) {
+        throw std::runtime_error("Corrupt block index in " + path.string());
+    }
+    index_ = {reinterpret_cast<const TickBlockIndex*>(file_.data() + header_.index_offset),
+              static_cast<size_t>(header_.block_count)};
+    uint64_t records = 0;
+    for (const TickBlockIndex& block : index_) {
+        if (block.offset >= header_.index_offset || block.offset % sizeof(uint64_t) != 0 ||
+            block.count > header_.block_size || !block_fits(block)) {
+            throw std::runtime_error("Corrupt block index in " + path.string());
+        }
+        records += block.count;
+    }
+    // Readers size their output from record_count, so it must match the blocks
+    if (records != header_.record_count) {
+        throw std::runtime_error("Corrupt block index in " + path.string());
+    }
+}
+
+bool TickFile::block_fits(const TickBlockIndex& block) const {
+    // Walk the column headers so a corrupt width can't send decode past the blocks
+    const auto* in  = reinterpret_cast<const uint64_t*>(file_.data() + block.offset);
+    const auto* end = reinterpret_cast<const uint64_t*>(file_.data() + header_.index_offset);
+    for (size_t c = 0; c < column_count_; ++c) {
+        if (end - in < 2) {
+            return false;
+        }
+        unsigned width = static_cast<unsigned>((in[0] >> 8) & 0xff);
+        if (width > 64 || static_cast<size_t>(end - in) < columnar::encoded_words(block.count, width)) {
+            return false;
+        }
+        in = columnar::skip_column(in, block.count);
+    }
+    return true;
+}
+
+void TickFile::decode_block(size_t block, int64_t* const* columns) const {
+    const uint64_t* in    = block_data(block);
+    size_t          count = index_[block].count;
+    for (size_t c = 0; c < column_count_; ++c) {
+        in = columnar::decode_column(in, count, columns[c]);
+    }
+}
+
+void TickFile::decode_column(size_t block, size_t column, int64_t* out) const {
+    const uint64_t* in    = block_data(block);
+    size_t          count = index_[block].count;
+    for (size_t c = 0; c < column; ++c) {
+        in = columnar::skip_column(in, count);
+    }
+    columnar::decode_column(in, count, out);
+}
+
+} // namespace hft
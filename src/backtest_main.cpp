@@ -0,0 +1,149 @@
+#include "Backtester.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <string>
+
+// Parallel historical backtest over a directory of recorded sessions laid
+// out as <root>/<day>/<symbol>.bin.
+//
+//   hft-backtest <root> [--threads N]
+//   hft-backtest <root> --sweep                           # sessions/s at 1, 2, 4, ... threads
+//   hft-backtest <root> --generate DAYS SYMBOLS UPDATES   # write a synthetic data set
+
+namespace {
+
+// Example strategy: fade moves away from an exponential moving average,
+// one lot at a time within a position limit
+class MeanReversionStrategy {
+public:
+    void on_market_update(const hft::RecordedUpdate& update, hft::BacktestContext& context) {
+        if (ema_ == 0.0) {
+            ema_ = update.price;
+            return;
+        }
+        ema_ += kAlpha * (update.price - ema_);
+
+        double deviation = (update.price - ema_) / ema_;
+        if (!update.is_buy && deviation < -kThreshold && context.position() < kMaxPosition) {
+            context.submit(update.price, kLot, true);  // Lift a cheap offer
+        } else if (update.is_buy && deviation > kThreshold && context.position() > -kMaxPosition) {
+            context.submit(update.price, kLot, false);  // Hit a rich bid
+        }
+    }
+
+private:
+    static constexpr double  kAlpha       = 0.01;
+    static constexpr double  kThreshold   = 0.0005;
+    static constexpr int64_t kLot         = 100;
+    static constexpr int64_t kMaxPosition = 1000;
+
+    double ema_ = 0.0;
+};
+
+void generate(const std::filesystem::path& root, int days, int symbols, int updates) {
+    std::vector<hft::RecordedUpdate> tape(updates);
+    for (int d = 0; d < days; ++d) {
+        std::string day = "2024-01-" + std::string(d + 1 < 10 ? "0" : "") + std::to_string(d + 1);
+        std::filesystem::create_directories(root / day);
+        for (int s = 0; s < symbols; ++s) {
+            std::mt19937_64                  rng(d * 1000 + s);
+            std::normal_distribution<double> step(0.0, 0.01);
+            double                           mid = 100.0 + s;
+            for (int i = 0; i < updates; ++i) {
+                mid += step(rng);
+                bool is_buy = rng() & 1;
+                tape[i]     = {
+                        .price     = std::round((is_buy ? mid - 0.01 : mid + 0.01) * 100.0) / 100.0,
+                        .quantity  = static_cast<int64_t>(rng() % 900 + 100),
+                        .is_buy    = is_buy,
+                        .timestamp = std::chrono::nanoseconds(int64_t{34'200'000'000'000} + i * 1'000'000LL),
+                };
+            }
+            hft::write_session_file(root / day / ("SYM" + std::to_string(s) + ".bin"), tape);
+        }
+    }
+}
+
+hft::Backtester<MeanReversionStrategy> make_backtester(hft::BacktestConfig config) {
+    return {std::move(config), [](const hft::SessionTask&) { return MeanReversionStrategy{}; }};
+}
+
+// Reruns the whole data set at doubling arena sizes up to the core count.
+// The first run also warms the page cache, so it is done twice and the
+// cold pass discarded.
+void sweep(const hft::BacktestConfig& config) {
+    int cores = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    make_backtester({.root = config.root, .threads = 1}).run();
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "threads  sessions/s   updates/s  speedup\n";
+    double serial = 0.0;
+    for (int threads = 1;; threads = std::min(threads * 2, cores)) {
+        hft::BacktestSummary summary = make_backtester({.root = config.root, .threads = threads}).run();
+        double sessions_per_second = static_cast<double>(summary.sessions.size()) / summary.wall_seconds;
+        if (threads == 1) {
+            serial = sessions_per_second;
+        }
+        std::cout << std::setw(7) << threads << std::setw(12) << sessions_per_second << std::setw(12)
+                  << static_cast<uint64_t>(static_cast<double>(summary.updates) / summary.wall_seconds)
+                  << std::setw(8) << sessions_per_second / serial << "x\n";
+        if (threads == cores) {
+            break;
+        }
+    }
+    std::cout << std::flush;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <root> [--threads N | --sweep] [--generate DAYS SYMBOLS UPDATES]"
+                  << std::endl;
+        return 1;
+    }
+
+    hft::BacktestConfig config{.root = argv[1]};
+    bool                run_sweep = false;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            config.threads = std::atoi(argv[++i]);
+        } else if (arg == "--sweep") {
+            run_sweep = true;
+        } else if (arg == "--generate" && i + 3 < argc) {
+            generate(config.root, std::atoi(argv[i + 1]), std::atoi(argv[i + 2]), std::atoi(argv[i + 3]));
+            return 0;
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (run_sweep) {
+        sweep(config);
+        return 0;
+    }
+
+    hft::BacktestSummary summary = make_backtester(config).run();
+
+    std::cout << std::fixed << std::setprecision(2);
+    for (const auto& session : summary.sessions) {
+        std::cout << session.day << " " << std::setw(8) << session.symbol << "  updates " << session.updates
+                  << "  fills " << session.fills << "  position " << session.position << "  pnl " << session.pnl()
+                  << "\n";
+    }
+    std::cout << "sessions:   " << summary.sessions.size() << "\n"
+              << "updates:    " << summary.updates << "\n"
+              << "fills:      " << summary.fills << " (" << summary.volume << " shares)\n"
+              << "pnl:        " << summary.pnl << "\n"
+              << "wall time:  " << summary.wall_seconds << " s\n"
+              << "throughput: " << static_cast<uint64_t>(summary.updates / summary.wall_seconds) << " updates/s"
+              << std::endl;
+    return 0;
+}
@@ -0,0 +1,157 @@
+#include "OrderGateway.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Loopback load generator for the order gateway. Each connection runs on its
+// own thread and ping-pongs new/cancel pairs, timing every request from send
+// to ack. Without --port an in-process gateway is started on loopback.
+//
+//   hft-gateway-loadgen [--host 127.0.0.1] [--port N] [--connections N] [--orders N] [--cpu N]
+
+namespace {
+
+struct Options {
+    std::string host        = "127.0.0.1";
+    uint16_t    port        = 0;
+    int         connections = 4;
+    int         orders      = 10000;  // New/cancel pairs per connection
+    int         cpu         = -1;     // Gateway pinning for the in-process gateway
+};
+
+Options parse_options(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string key   = argv[i];
+        const char* value = argv[i + 1];
+        if (key == "--host") {
+            options.host = value;
+        } else if (key == "--port") {
+            options.port = static_cast<uint16_t>(std::atoi(value));
+        } else if (key == "--connections") {
+            options.connections = std::max(1, std::atoi(value));
+        } else if (key == "--orders") {
+            options.orders = std::max(1, std::atoi(value));
+        } else if (key == "--cpu") {
+            options.cpu = std::atoi(value);
+        } else {
+            std::cerr << "Unknown option " << key << std::endl;
+            std::exit(1);
+        }
+    }
+    return options;
+}
+
+uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// Waits for the ack or reject answering client_order_id, skipping fills
+bool await_response(hft::OrderGatewayClient& client, uint64_t client_order_id) {
+    while (true) {
+        const auto& header = client.receive();
+        if (header.type == hft::protocol::MessageType::Ack) {
+            const auto& ack = hft::protocol::message_cast<hft::protocol::Ack>(&header);
+            if (ack.client_order_id == client_order_id) {
+                return true;
+            }
+        } else if (header.type == hft::protocol::MessageType::Reject) {
+            const auto& reject = hft::protocol::message_cast<hft::protocol::Reject>(&header);
+            if (reject.client_order_id == client_order_id) {
+                return false;
+            }
+        }
+    }
+}
+
+void run_connection(const Options& options, int index, std::vector<uint64_t>& latencies, uint64_t& rejects) {
+    hft::OrderGatewayClient client;
+    client.connect(options.host, options.port);
+    latencies.reserve(static_cast<size_t>(options.orders) * 2);
+
+    // Bids only, spread below one another per connection so nothing crosses
+    double price = 100.0 - index * 0.01;
+    for (int i = 0; i < options.orders; ++i) {
+        uint64_t client_order_id = static_cast<uint64_t>(i) + 1;
+
+        uint64_t start = now_ns();
+        client.send_new_order(client_order_id, price, 100, true, start);
+        bool ok = await_response(client, client_order_id);
+        latencies.push_back(now_ns() - start);
+        if (!ok) {
+            ++rejects;
+            continue;
+        }
+
+        start = now_ns();
+        client.send_cancel(client_order_id, start);
+        ok = await_response(client, client_order_id);
+        latencies.push_back(now_ns() - start);
+        rejects += ok ? 0 : 1;
+    }
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    size_t index = static_cast<size_t>(p / 100.0 * (sorted.size() - 1));
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options options = parse_options(argc, argv);
+
+    hft::OrderGateway::Engine           engine;
+    std::unique_ptr<hft::OrderGateway> gateway;
+    if (options.port == 0) {
+        gateway = std::make_unique<hft::OrderGateway>(engine, hft::GatewayConfig{.cpu = options.cpu});
+        gateway->start();
+        options.port = gateway->port();
+    }
+
+    std::vector<std::vector<uint64_t>> latencies(options.connections);
+    std::vector<uint64_t>              rejects(options.connections, 0);
+    std::vector<std::thread>           threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < options.connections; ++i) {
+        threads.emplace_back([&, i]() { run_connection(options, i, latencies[i], rejects[i]); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<uint64_t> all;
+    uint64_t              total_rejects = 0;
+    for (int i = 0; i < options.connections; ++i) {
+        all.insert(all.end(), latencies[i].begin(), latencies[i].end());
+        total_rejects += rejects[i];
+    }
+    std::sort(all.begin(), all.end());
+
+    std::cout << "connections:  " << options.connections << "\n"
+              << "requests:     " << all.size() << " (" << total_rejects << " rejected)\n"
+              << "throughput:   " << static_cast<uint64_t>(all.size() / elapsed) << " req/s\n"
+              << "rtt p50:      " << percentile(all, 50) << " ns\n"
+              << "rtt p90:      " << percentile(all, 90) << " ns\n"
+              << "rtt p99:      " << percentile(all, 99) << " ns\n"
+              << "rtt p99.9:    " << percentile(all, 99.9) << " ns\n"
+              << "rtt max:      " << all.back() << " ns\n";
+
+    if (gateway) {
+        auto stats = gateway->stats();
+        std::cout << "gateway:      " << stats.messages_in << " in, " << stats.messages_out << " out, "
+                  << stats.socket_writes << " writes, " << stats.batches << " batches" << std::endl;
+        gateway->stop();
+    }
+    return 0;
+}
@@ -2,6 +2,13 @@
 #include "OrderBook.hpp"
 #include "MatchingEngine.hpp"
 #include "Utils.hpp"
+#include "L3BookBuilder.hpp"
+#include "TickStore.hpp"
+#include "ThreadServices.hpp"
+#include <filesystem>
+#include <unistd.h>
+#include <random>
+#include <vector>
 
 static void BM_OrderBookAdd_NoLock(benchmark::State& state) {
     hft::OrderBook<double, int64_t, uint64_t> book;
@@ -37,4 +44,241 @@ static void BM_OrderBookAdd_WithLock(benchmark::State& state) {
 }
 BENCHMARK(BM_OrderBookAdd_WithLock);
 
+// Synthetic L3 day: build up a deep book of live orders, then stream a
+// steady-state mix of adds, cancels, executes, replaces and deletes
+static const std::vector<hft::OrderUpdate<double, int64_t>>& synthetic_l3_day() {
+    static const auto events = [] {
+        constexpr size_t live_target = 1'000'000;
+        constexpr size_t steady_events = 3'000'000;
+        constexpr uint32_t symbols = 100;
+
+        std::vector<hft::OrderUpdate<double, int64_t>> out;
+        out.reserve(live_target + steady_events);
+        std::mt19937_64 rng(42);
+        std::vector<uint64_t> live;
+        live.reserve(live_target * 2);
+        uint64_t next_ref = 1;
+        std::vector<uint8_t> side_of(1);  // Indexed by order ref
+        side_of.reserve(live_target + steady_events + 1);
+
+        auto add = [&] {
+            uint64_t ref = next_ref++;
+            bool is_buy = rng() & 1;
+            side_of.push_back(is_buy);
+            double offset = static_cast<double>(rng() % 200) * 0.01;
+            out.push_back({.type = hft::OrderEventType::Add, .symbol = static_cast<uint32_t>(ref % symbols),
+                           .order_ref = ref, .new_order_ref = 0,
+                           .price = is_buy ? 100.0 - offset : 100.01 + offset,
+                           .quantity = static_cast<int64_t>(rng() % 500 + 100), .is_buy = is_buy,
+                           .timestamp = std::chrono::nanoseconds(out.size())});
+            live.push_back(ref);
+        };
+        auto take = [&]() {
+            size_t i = rng() % live.size();
+            uint64_t ref = live[i];
+            live[i] = live.back();
+            live.pop_back();
+            return ref;
+        };
+
+        while (live.size() < live_target) {
+            add();
+        }
+        for (size_t i = 0; i < steady_events; i++) {
+            unsigned roll = rng() % 100;
+            auto ts = std::chrono::nanoseconds(out.size());
+            if (roll < 45 || live.empty()) {
+                add();
+            } else if (roll < 80) {
+                out.push_back({.type = hft::OrderEventType::Delete, .symbol = 0, .order_ref = take(),
+                               .new_order_ref = 0, .price = 0, .quantity = 0, .is_buy = false, .timestamp = ts});
+            } else if (roll < 90) {
+                // Partial cancel: leaves the order live
+                out.push_back({.type = hft::OrderEventType::Cancel, .symbol = 0, .order_ref = live[rng() % live.size()],
+                               .new_order_ref = 0, .price = 0, .quantity = 1, .is_buy = false, .timestamp = ts});
+            } else if (roll < 95) {
+                out.push_back({.type = hft::OrderEventType::Execute, .symbol = 0, .order_ref = take(),
+                               .new_order_ref = 0, .price = 0, .quantity = 1'000, .is_buy = false, .timestamp = ts});
+            } else {
+                uint64_t ref = take();
+                uint64_t new_ref = next_ref++;
+                bool is_buy = side_of[ref];
+                side_of.push_back(is_buy);
+                double offset = static_cast<double>(rng() % 200) * 0.01;
+                out.push_back({.type = hft::OrderEventType::Replace, .symbol = 0, .order_ref = ref,
+                               .new_order_ref = new_ref, .price = is_buy ? 100.0 - offset : 100.01 + offset,
+                               .quantity = 100, .is_buy = is_buy, .timestamp = ts});
+                live.push_back(new_ref);
+            }
+        }
+        return out;
+    }();
+    return events;
+}
+
+static void BM_L3BookBuilder_SyntheticDay(benchmark::State& state) {
+    const auto& events = synthetic_l3_day();
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto builder = std::make_unique<hft::L3BookBuilder<double, int64_t>>(2'000'000, 128);
+        state.ResumeTiming();
+
+        for (const auto& event : events) {
+            builder->apply(event);
+        }
+        benchmark::DoNotOptimize(builder->live_orders());
+
+        state.PauseTiming();
+        builder.reset();
+        state.ResumeTiming();
+    }
+    // Reported as items_per_second, i.e. sustained messages per second
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * events.size()));
+}
+BENCHMARK(BM_L3BookBuilder_SyntheticDay)->Unit(benchmark::kMillisecond);
+
+// One million updates of a random-walk tape, stored raw and columnar
+struct TickFiles {
+    TickFiles() {
+        std::mt19937_64 rng(7);
+        int64_t ticks = 1000000;
+        tape.reserve(1 << 20);
+        for (size_t i = 0; i < (1 << 20); ++i) {
+            ticks += static_cast<int64_t>(rng() % 5) - 2;
+            tape.push_back({.price = hft::protocol::from_ticks(ticks),
+                            .quantity = static_cast<int64_t>(rng() % 1000) + 1,
+                            .is_buy = (rng() & 1) != 0,
+                            .timestamp = std::chrono::nanoseconds(34'200'000'000'000 + i * 1000 + rng() % 100)});
+        }
+        auto dir = std::filesystem::temp_directory_path();
+        raw = dir / ("hft-bench-" + std::to_string(::getpid()) + ".bin");
+        columnar = dir / ("hft-bench-" + std::to_string(::getpid()) + ".htc");
+        hft::write_session_file(raw, tape);
+        hft::TickWriter<hft::RecordedUpdate> writer(columnar);
+        writer.append(tape);
+        writer.close();
+    }
+    ~TickFiles() {
+        std::filesystem::remove(raw);
+        std::filesystem::remove(columnar);
+    }
+
+    double ratio() const {
+        return static_cast<double>(std::filesystem::file_size(raw)) /
+               static_cast<double>(std::filesystem::file_size(columnar));
+    }
+
+    std::vector<hft::RecordedUpdate> tape;
+    std::filesystem::path raw;
+    std::filesystem::path columnar;
+};
+
+static TickFiles& tick_files() {
+    static TickFiles files;
+    return files;
+}
+
+// Throughput below is in raw-format bytes so the rates compare directly
+static void BM_TickStore_Encode(benchmark::State& state) {
+    auto& files = tick_files();
+    auto path = files.columnar;
+    path += ".encode";
+    for (auto _ : state) {
+        hft::TickWriter<hft::RecordedUpdate> writer(path);
+        writer.append(files.tape);
+        writer.close();
+    }
+    std::filesystem::remove(path);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * files.tape.size() * sizeof(hft::RecordedUpdate)));
+    state.counters["ratio"] = files.ratio();
+}
+BENCHMARK(BM_TickStore_Encode)->Unit(benchmark::kMillisecond);
+
+static void BM_TickStore_Decode(benchmark::State& state) {
+    auto& files = tick_files();
+    hft::TickReader<hft::RecordedUpdate> reader(files.columnar);
+    std::vector<hft::RecordedUpdate> out;
+    out.reserve(files.tape.size());
+    for (auto _ : state) {
+        out.clear();
+        for (size_t b = 0; b < reader.blocks().size(); ++b) {
+            reader.read_block(b, out);
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * files.tape.size() * sizeof(hft::RecordedUpdate)));
+    state.counters["ratio"] = files.ratio();
+}
+BENCHMARK(BM_TickStore_Decode)->Unit(benchmark::kMillisecond);
+
+// Research-style scan of one field: only the price column is decoded
+static void BM_TickStore_PriceColumn(benchmark::State& state) {
+    auto& files = tick_files();
+    hft::TickReader<hft::RecordedUpdate> reader(files.columnar);
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (size_t b = 0; b < reader.blocks().size(); ++b) {
+            for (int64_t ticks : reader.column(b, 1)) {
+                sum += ticks;
+            }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * files.tape.size() * sizeof(hft::RecordedUpdate)));
+}
+BENCHMARK(BM_TickStore_PriceColumn)->Unit(benchmark::kMillisecond);
+
+// Baseline: the raw mapped format needs no decoding, only a pass over the pages
+static void BM_SessionFile_Scan(benchmark::State& state) {
+    auto& files = tick_files();
+    hft::SessionReader reader(files.raw);
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (const auto& update : reader.updates()) {
+            sum += update.quantity;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * files.tape.size() * sizeof(hft::RecordedUpdate)));
+}
+BENCHMARK(BM_SessionFile_Scan)->Unit(benchmark::kMillisecond);
+
+// ID and timestamp cost per order as submitting threads are added. The
+// global counter's cache line bounces between cores; the per-thread
+// services touch shared state once per block or anchor interval.
+static void BM_GlobalOrderId(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hft::utils::generate_order_id());
+    }
+}
+BENCHMARK(BM_GlobalOrderId)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_ThreadOrderId(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hft::utils::thread_order_id());
+    }
+}
+BENCHMARK(BM_ThreadOrderId)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_CurrentTime(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hft::utils::current_time());
+    }
+}
+BENCHMARK(BM_CurrentTime)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_ThreadTime(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hft::utils::thread_time());
+    }
+}
+BENCHMARK(BM_ThreadTime)->ThreadRange(1, 8)->UseRealTime();
+
+static void BM_CoarseTime(benchmark::State& state) {
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(hft::utils::ThreadClock::coarse());
+    }
+}
+BENCHMARK(BM_CoarseTime)->ThreadRange(1, 8)->UseRealTime();
+
 BENCHMARK_MAIN(); 
\ No newline at end of file
@@ -9,6 +9,24 @@
 #include <atomic>
 #include <vector>
 #include "SharedPtr.hpp"  // Add at top with other includes
+#include "SpscRing.hpp"
+#include "MarketDataPublisher.hpp"
+#include "OrderProtocol.hpp"
+#include "L3BookBuilder.hpp"
+#include "Backtester.hpp"
+#include "TickStore.hpp"
+#include "EngineIngress.hpp"
+#include "ThreadServices.hpp"
+#include <filesystem>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <fstream>
+#include <ctime>
+#include <cstring>
+#ifdef __linux__
+#include "OrderGateway.hpp"
+#endif
 
 // Add timing fixture
 struct TimingFixture {
@@ -226,4 +244,1314 @@ BOOST_AUTO_TEST_CASE(test_reset) {
     BOOST_CHECK_EQUAL(ptr.use_count(), 1);
 }
 
-BOOST_AUTO_TEST_SUITE_END() 
\ No newline at end of file
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(OrderProtocolTests)
+
+BOOST_AUTO_TEST_CASE(test_decode_framing) {
+    auto msg = hft::protocol::make_message<hft::protocol::CancelOrder>();
+    msg.client_order_id = 7;
+    const char* bytes = reinterpret_cast<const char*>(&msg);
+
+    auto partial = hft::protocol::decode(bytes, sizeof(msg) - 1);
+    BOOST_CHECK(partial.status == hft::protocol::DecodeStatus::Incomplete);
+
+    auto full = hft::protocol::decode(bytes, sizeof(msg));
+    BOOST_REQUIRE(full.status == hft::protocol::DecodeStatus::Ok);
+    BOOST_CHECK_EQUAL(hft::protocol::message_cast<hft::protocol::CancelOrder>(full.header).client_order_id, 7u);
+
+    msg.header.length = 3;
+    auto bad = hft::protocol::decode(bytes, sizeof(msg));
+    BOOST_CHECK(bad.status == hft::protocol::DecodeStatus::Malformed);
+}
+
+BOOST_AUTO_TEST_CASE(test_price_ticks) {
+    BOOST_CHECK_EQUAL(hft::protocol::to_ticks(100.25), 1002500);
+    BOOST_CHECK_EQUAL(hft::protocol::from_ticks(1002500), 100.25);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#ifdef __linux__
+
+BOOST_AUTO_TEST_SUITE(OrderGatewayTests)
+
+BOOST_AUTO_TEST_CASE(test_engine_outlives_gateway) {
+    hft::OrderGateway::Engine engine;
+    {
+        hft::OrderGateway gateway(engine);
+        gateway.start();
+    }
+    // Crossing orders fire the fill callback, which must no longer point at the gateway
+    engine.handle_order({.id = 1, .price = 100.0, .quantity = 10, .is_buy = false, .timestamp = {}});
+    engine.handle_order({.id = 2, .price = 100.0, .quantity = 10, .is_buy = true, .timestamp = {}});
+    BOOST_CHECK_NO_THROW(engine.cancel_order(2));
+}
+
+BOOST_AUTO_TEST_CASE(test_gateway_restores_fill_callback) {
+    hft::OrderGateway::Engine engine;
+    int fills = 0;
+    engine.set_fill_callback([&fills](const uint64_t&, double, int64_t) { ++fills; });
+    {
+        hft::OrderGateway idle(engine);  // Never started, so never touches the callback
+    }
+    {
+        hft::OrderGateway gateway(engine);
+        gateway.start();
+        gateway.stop();
+    }
+    engine.handle_order({.id = 1, .price = 100.0, .quantity = 10, .is_buy = false, .timestamp = {}});
+    engine.handle_order({.id = 2, .price = 100.0, .quantity = 10, .is_buy = true, .timestamp = {}});
+    BOOST_CHECK_EQUAL(fills, 1);
+}
+
+BOOST_AUTO_TEST_CASE(test_rejects_malformed_orders) {
+    hft::OrderGateway::Engine engine;
+    hft::OrderGateway gateway(engine);
+    gateway.start();
+
+    hft::OrderGatewayClient client;
+    client.connect("127.0.0.1", gateway.port());
+
+    auto expect_malformed = [&client](hft::protocol::MessageType type) {
+        const auto& reject = hft::protocol::message_cast<hft::protocol::Reject>(&client.receive());
+        BOOST_REQUIRE(reject.header.type == hft::protocol::MessageType::Reject);
+        BOOST_CHECK(reject.rejected_type == type);
+        BOOST_CHECK(reject.reason == hft::protocol::RejectReason::Malformed);
+    };
+
+    client.send_new_order(1, 100.0, 0, true);
+    expect_malformed(hft::protocol::MessageType::NewOrder);
+    client.send_new_order(2, -1.0, 10, true);
+    expect_malformed(hft::protocol::MessageType::NewOrder);
+
+    auto bad_side            = hft::protocol::make_message<hft::protocol::NewOrder>();
+    bad_side.client_order_id = 3;
+    bad_side.price           = hft::protocol::to_ticks(100.0);
+    bad_side.quantity        = 10;
+    bad_side.is_buy          = 7;
+    client.send_raw(&bad_side, sizeof(bad_side));
+    expect_malformed(hft::protocol::MessageType::NewOrder);
+
+    // A bad replace leaves the original resting
+    client.send_new_order(4, 100.0, 10, true);
+    BOOST_REQUIRE(client.receive().type == hft::protocol::MessageType::Ack);
+    client.send_replace(4, 5, 100.0, 0);
+    expect_malformed(hft::protocol::MessageType::ReplaceOrder);
+    client.send_cancel(4);
+    const auto& cancel_ack = hft::protocol::message_cast<hft::protocol::Ack>(&client.receive());
+    BOOST_REQUIRE(cancel_ack.header.type == hft::protocol::MessageType::Ack);
+    BOOST_CHECK_EQUAL(cancel_ack.client_order_id, 4u);
+}
+
+BOOST_AUTO_TEST_CASE(test_slow_reader_disconnected) {
+    hft::OrderGateway::Engine engine;
+    hft::OrderGateway gateway(engine, {.max_pending_out = sizeof(hft::protocol::Ack) - 1});
+    gateway.start();
+
+    hft::OrderGatewayClient client;
+    client.connect("127.0.0.1", gateway.port());
+    client.send_new_order(1, 100.0, 10, true);
+    BOOST_CHECK_THROW(client.receive(), std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_new_cancel_round_trip) {
+    hft::OrderGateway::Engine engine;
+    hft::OrderGateway gateway(engine);
+    gateway.start();
+
+    hft::OrderGatewayClient client;
+    client.connect("127.0.0.1", gateway.port());
+
+    client.send_new_order(1, 100.0, 100, true, 42);
+    const auto& ack = hft::protocol::message_cast<hft::protocol::Ack>(&client.receive());
+    BOOST_REQUIRE(ack.header.type == hft::protocol::MessageType::Ack);
+    BOOST_CHECK(ack.acked_type == hft::protocol::MessageType::NewOrder);
+    BOOST_CHECK_EQUAL(ack.client_order_id, 1u);
+    BOOST_CHECK_EQUAL(ack.client_timestamp, 42u);
+    BOOST_CHECK(ack.order_id != 0);
+
+    client.send_cancel(1);
+    const auto& cancel_ack = hft::protocol::message_cast<hft::protocol::Ack>(&client.receive());
+    BOOST_REQUIRE(cancel_ack.header.type == hft::protocol::MessageType::Ack);
+    BOOST_CHECK(cancel_ack.acked_type == hft::protocol::MessageType::CancelOrder);
+
+    client.send_cancel(1);
+    const auto& reject = hft::protocol::message_cast<hft::protocol::Reject>(&client.receive());
+    BOOST_REQUIRE(reject.header.type == hft::protocol::MessageType::Reject);
+    BOOST_CHECK(reject.reason == hft::protocol::RejectReason::UnknownOrder);
+}
+
+BOOST_AUTO_TEST_CASE(test_fill_and_replace) {
+    hft::OrderGateway::Engine engine;
+    hft::OrderGateway gateway(engine);
+    gateway.start();
+
+    hft::OrderGatewayClient client;
+    client.connect("127.0.0.1", gateway.port());
+
+    client.send_new_order(1, 100.0, 100, true);
+    BOOST_REQUIRE(client.receive().type == hft::protocol::MessageType::Ack);
+
+    client.send_replace(1, 2, 99.5, 50);
+    const auto& replace_ack = hft::protocol::message_cast<hft::protocol::Ack>(&client.receive());
+    BOOST_REQUIRE(replace_ack.header.type == hft::protocol::MessageType::Ack);
+    BOOST_CHECK(replace_ack.acked_type == hft::protocol::MessageType::ReplaceOrder);
+    BOOST_CHECK_EQUAL(replace_ack.client_order_id, 2u);
+
+    // Crossing sell is acked first, then filled against the bid
+    client.send_new_order(3, 99.0, 50, false);
+    BOOST_REQUIRE(client.receive().type == hft::protocol::MessageType::Ack);
+    const auto& fill = hft::protocol::message_cast<hft::protocol::Fill>(&client.receive());
+    BOOST_REQUIRE(fill.header.type == hft::protocol::MessageType::Fill);
+    BOOST_CHECK_EQUAL(fill.client_order_id, 3u);
+    BOOST_CHECK_EQUAL(hft::protocol::from_ticks(fill.price), 99.5);
+}
+
+BOOST_AUTO_TEST_CASE(test_pipelined_batch) {
+    hft::OrderGateway::Engine engine;
+    hft::OrderGateway gateway(engine);
+    gateway.start();
+
+    hft::OrderGatewayClient client;
+    client.connect("127.0.0.1", gateway.port());
+
+    // Several requests in a single segment are decoded and answered as one batch
+    std::vector<hft::protocol::NewOrder> orders;
+    for (uint64_t i = 1; i <= 8; ++i) {
+        auto msg = hft::protocol::make_message<hft::protocol::NewOrder>();
+        msg.client_order_id = i;
+        msg.price = hft::protocol::to_ticks(100.0);
+        msg.quantity = 10;
+        msg.is_buy = 1;
+        orders.push_back(msg);
+    }
+    client.send_raw(orders.data(), orders.size() * sizeof(hft::protocol::NewOrder));
+
+    for (uint64_t i = 1; i <= 8; ++i) {
+        const auto& ack = hft::protocol::message_cast<hft::protocol::Ack>(&client.receive());
+        BOOST_REQUIRE(ack.header.type == hft::protocol::MessageType::Ack);
+        BOOST_CHECK_EQUAL(ack.client_order_id, i);
+    }
+
+    client.send_new_order(1, 100.0, 10, true);
+    const auto& reject = hft::protocol::message_cast<hft::protocol::Reject>(&client.receive());
+    BOOST_REQUIRE(reject.header.type == hft::protocol::MessageType::Reject);
+    BOOST_CHECK(reject.reason == hft::protocol::RejectReason::DuplicateId);
+
+    auto stats = gateway.stats();
+    BOOST_CHECK_EQUAL(stats.messages_in, 9u);
+    BOOST_CHECK(stats.socket_writes <= stats.messages_out);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif // __linux__
+
+BOOST_AUTO_TEST_SUITE(SpscRingTests)
+
+BOOST_AUTO_TEST_CASE(test_fifo_and_capacity) {
+    hft::SpscRing<int> ring(4);
+    for (int i = 0; i < 4; i++) {
+        BOOST_CHECK(ring.try_push(i));
+    }
+    BOOST_CHECK(!ring.try_push(4));
+
+    int value = -1;
+    for (int i = 0; i < 4; i++) {
+        BOOST_REQUIRE(ring.try_pop(value));
+        BOOST_CHECK_EQUAL(value, i);
+    }
+    BOOST_CHECK(!ring.try_pop(value));
+    BOOST_CHECK_THROW(hft::SpscRing<int>(6), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE(test_cross_thread_order) {
+    hft::SpscRing<uint64_t> ring(64);
+    constexpr uint64_t count = 100000;
+
+    std::thread producer([&ring]() {
+        for (uint64_t i = 0; i < count; i++) {
+            while (!ring.try_push(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    bool in_order = true;
+    for (uint64_t expected = 0; expected < count;) {
+        uint64_t value;
+        if (ring.try_pop(value)) {
+            in_order &= value == expected;
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    BOOST_CHECK(in_order);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(MarketDataPublisherTests)
+
+struct FeedMessage {
+    uint64_t sequence;
+    hft::feed::MessageType type;
+    bool is_buy;
+    int64_t price;
+    int64_t quantity;
+};
+
+// Collects every message that arrives until the feed goes quiet
+static std::vector<FeedMessage> drain_feed(hft::MarketDataReceiver& receiver, size_t max_packet_size = 0) {
+    std::vector<FeedMessage> messages;
+    char buffer[2048];
+    while (size_t size = receiver.receive(buffer, sizeof(buffer), std::chrono::milliseconds(100))) {
+        if (max_packet_size) {
+            BOOST_CHECK_LE(size, max_packet_size);
+        }
+        bool ok = hft::feed::for_each_message(buffer, size, [&](uint64_t sequence, const hft::feed::MessageHeader& header) {
+            FeedMessage msg{sequence, header.type, header.is_buy != 0, 0, 0};
+            if (header.type == hft::feed::MessageType::Trade) {
+                const auto& trade = hft::feed::message_cast<hft::feed::Trade>(header);
+                msg.price = trade.price;
+                msg.quantity = trade.quantity;
+            } else if (header.length == sizeof(hft::feed::LevelUpdate)) {
+                const auto& level = hft::feed::message_cast<hft::feed::LevelUpdate>(header);
+                msg.price = level.price;
+                msg.quantity = level.quantity;
+            }
+            messages.push_back(msg);
+        });
+        BOOST_CHECK(ok);
+    }
+    return messages;
+}
+
+BOOST_AUTO_TEST_CASE(test_incremental_feed) {
+    hft::MarketDataReceiver receiver;
+    receiver.open("239.255.0.1", 0);
+
+    hft::MarketDataPublisher::Engine engine;
+    hft::MarketDataPublisher publisher({.port = receiver.port(), .snapshot_interval = std::chrono::hours(1)});
+    publisher.attach(engine);
+    publisher.start();
+
+    engine.handle_order({.id = 1, .price = 100.0, .quantity = 100, .is_buy = true, .timestamp = {}});
+    engine.handle_order({.id = 2, .price = 100.0, .quantity = 50, .is_buy = true, .timestamp = {}});
+    engine.handle_order({.id = 3, .price = 100.0, .quantity = 10, .is_buy = false, .timestamp = {}});
+    engine.cancel_order(1);
+    engine.cancel_order(2);
+    publisher.stop();
+
+    auto messages = drain_feed(receiver);
+    using hft::feed::MessageType;
+    std::vector<MessageType> expected{MessageType::LevelAdd, MessageType::LevelModify, MessageType::LevelAdd,
+                                      MessageType::Trade, MessageType::LevelModify, MessageType::LevelDelete};
+    BOOST_REQUIRE_EQUAL(messages.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        BOOST_CHECK(messages[i].type == expected[i]);
+        BOOST_CHECK_EQUAL(messages[i].sequence, i + 1);
+    }
+    BOOST_CHECK_EQUAL(messages[1].quantity, 150);
+    BOOST_CHECK_EQUAL(messages[3].price, hft::protocol::to_ticks(100.0));
+    BOOST_CHECK(!messages[3].is_buy);
+    BOOST_CHECK_EQUAL(messages[4].quantity, 50);
+}
+
+BOOST_AUTO_TEST_CASE(test_packets_fit_mtu) {
+    hft::MarketDataReceiver receiver;
+    receiver.open("239.255.0.1", 0);
+
+    hft::MarketDataPublisher publisher({.port = receiver.port(), .max_packet_size = 512,
+                                        .snapshot_interval = std::chrono::hours(1)});
+    publisher.start();
+    for (int i = 0; i < 1000; i++) {
+        publisher.on_level(hft::LevelAction::Add, true, 100.0 - i * 0.01, 100);
+    }
+    publisher.stop();
+
+    auto messages = drain_feed(receiver, 512);
+    BOOST_REQUIRE_EQUAL(messages.size(), 1000u);
+    BOOST_CHECK_EQUAL(messages.back().sequence, 1000u);
+    auto stats = publisher.stats();
+    BOOST_CHECK_EQUAL(stats.messages, 1000u);
+    BOOST_CHECK_LT(stats.packets, 1000u);
+}
+
+BOOST_AUTO_TEST_CASE(test_periodic_snapshot) {
+    hft::MarketDataReceiver receiver;
+    receiver.open("239.255.0.1", 0);
+
+    hft::MarketDataPublisher publisher({.port = receiver.port(), .snapshot_interval = std::chrono::milliseconds(20)});
+    publisher.start();
+    publisher.on_level(hft::LevelAction::Add, true, 99.0, 10);
+    publisher.on_level(hft::LevelAction::Add, false, 101.0, 20);
+    publisher.on_level(hft::LevelAction::Add, false, 102.0, 30);
+    publisher.on_level(hft::LevelAction::Delete, false, 102.0, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    publisher.stop();
+
+    auto messages = drain_feed(receiver);
+    auto begin = std::find_if(messages.begin(), messages.end(),
+                              [](const FeedMessage& m) { return m.type == hft::feed::MessageType::SnapshotBegin; });
+    BOOST_REQUIRE(begin != messages.end());
+    BOOST_REQUIRE_GE(messages.end() - begin, 4);
+    BOOST_CHECK(begin[1].type == hft::feed::MessageType::SnapshotLevel);
+    BOOST_CHECK(begin[1].is_buy);
+    BOOST_CHECK_EQUAL(begin[1].quantity, 10);
+    BOOST_CHECK(begin[2].type == hft::feed::MessageType::SnapshotLevel);
+    BOOST_CHECK(!begin[2].is_buy);
+    BOOST_CHECK_EQUAL(begin[2].price, hft::protocol::to_ticks(101.0));
+    BOOST_CHECK(begin[3].type == hft::feed::MessageType::SnapshotEnd);
+    BOOST_CHECK_GE(publisher.stats().snapshots, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_engine_outlives_publisher) {
+    hft::MarketDataPublisher::Engine engine;
+    {
+        hft::MarketDataPublisher publisher({.port = 0});
+        publisher.attach(engine);
+        publisher.start();
+        publisher.stop();
+        // Stopped: nothing drains the ring, so pushes must not queue or wait
+        for (int i = 0; i < 100; i++) {
+            engine.handle_order({.id = static_cast<uint64_t>(i + 1), .price = 100.0 - i * 0.01, .quantity = 10,
+                                 .is_buy = true, .timestamp = {}});
+        }
+        BOOST_CHECK_EQUAL(publisher.stats().ring_full, 0u);
+    }
+    // Callbacks were removed with the publisher
+    engine.handle_order({.id = 1000, .price = 99.0, .quantity = 10, .is_buy = false, .timestamp = {}});
+    BOOST_CHECK_NO_THROW(engine.cancel_order(1000));
+}
+
+// The levels in the last snapshot of a drained feed
+static std::map<std::pair<bool, int64_t>, int64_t> last_snapshot(const std::vector<FeedMessage>& messages) {
+    std::map<std::pair<bool, int64_t>, int64_t> book;
+    for (const FeedMessage& m : messages) {
+        if (m.type == hft::feed::MessageType::SnapshotBegin) {
+            book.clear();
+        } else if (m.type == hft::feed::MessageType::SnapshotLevel) {
+            book[{m.is_buy, m.price}] = m.quantity;
+        }
+    }
+    return book;
+}
+
+BOOST_AUTO_TEST_CASE(test_changes_while_stopped_reach_snapshot) {
+    hft::MarketDataReceiver receiver;
+    receiver.open("239.255.0.1", 0);
+
+    hft::MarketDataPublisher::Engine engine;
+    hft::MarketDataPublisher publisher({.port = receiver.port(), .snapshot_interval = std::chrono::hours(1)});
+    publisher.attach(engine);
+
+    // Before the first start()
+    engine.handle_order({.id = 1, .price = 99.0, .quantity = 100, .is_buy = true, .timestamp = {}});
+    engine.handle_order({.id = 2, .price = 99.0, .quantity = 50, .is_buy = true, .timestamp = {}});
+    engine.handle_order({.id = 3, .price = 101.0, .quantity = 20, .is_buy = false, .timestamp = {}});
+    engine.handle_order({.id = 4, .price = 102.0, .quantity = 30, .is_buy = false, .timestamp = {}});
+    engine.cancel_order(4);
+    publisher.start();
+    publisher.stop();
+
+    auto first = drain_feed(receiver);
+    BOOST_REQUIRE(!first.empty());
+    BOOST_CHECK(first.back().type == hft::feed::MessageType::SnapshotEnd);
+    std::map<std::pair<bool, int64_t>, int64_t> expected{
+        {{true, hft::protocol::to_ticks(99.0)}, 150},
+        {{false, hft::protocol::to_ticks(101.0)}, 20},
+    };
+    BOOST_CHECK(last_snapshot(first) == expected);
+
+    // Across a stop/start cycle
+    engine.handle_order({.id = 5, .price = 101.0, .quantity = 5, .is_buy = false, .timestamp = {}});
+    engine.cancel_order(1);
+    publisher.start();
+    publisher.stop();
+
+    expected[{false, hft::protocol::to_ticks(101.0)}] = 25;
+    expected[{true, hft::protocol::to_ticks(99.0)}]   = 50;
+    BOOST_CHECK(last_snapshot(drain_feed(receiver)) == expected);
+    BOOST_CHECK_EQUAL(publisher.stats().ring_full, 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_idle_encoder_wakes_for_events) {
+    hft::MarketDataReceiver receiver;
+    receiver.open("239.255.0.1", 0);
+
+    hft::MarketDataPublisher publisher({.port = receiver.port(), .snapshot_interval = std::chrono::hours(1),
+                                        .idle_spins = 1});
+    publisher.start();
+    // An idle encoder blocks instead of spinning through the process's CPU time
+    std::clock_t cpu_before = std::clock();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    double cpu_ms = 1000.0 * static_cast<double>(std::clock() - cpu_before) / CLOCKS_PER_SEC;
+    BOOST_CHECK_LT(cpu_ms, 50.0);
+    publisher.on_level(hft::LevelAction::Add, true, 99.0, 10);
+
+    // Published without stop() forcing a drain
+    char buffer[2048];
+    BOOST_CHECK_GT(receiver.receive(buffer, sizeof(buffer), std::chrono::milliseconds(1000)), 0u);
+    publisher.stop();
+}
+
+BOOST_AUTO_TEST_CASE(test_full_ring_conflates_without_waiting) {
+    hft::MarketDataReceiver receiver;
+    receiver.open("239.255.0.1", 0);
+
+    hft::MarketDataPublisher publisher({.port = receiver.port(), .ring_capacity = 4,
+                                        .snapshot_interval = std::chrono::hours(1)});
+    publisher.start();
+    std::map<int64_t, int64_t> expected;
+    for (int i = 0; i < 2000; i++) {
+        double price = 100.0 - (i % 20) * 0.01;
+        publisher.on_level(i < 20 ? hft::LevelAction::Add : hft::LevelAction::Modify, true, price, i + 1);
+        expected[hft::protocol::to_ticks(price)] = i + 1;
+    }
+    for (int i = 0; i < 20; i += 5) {
+        double price = 100.0 - i * 0.01;
+        publisher.on_level(hft::LevelAction::Delete, true, price, 0);
+        expected.erase(hft::protocol::to_ticks(price));
+    }
+    publisher.on_trade(100.0, 5, false);
+    publisher.stop();
+
+    // Whatever was conflated, the receiver's book must end up where the producer's did
+    std::map<int64_t, int64_t> book;
+    using hft::feed::MessageType;
+    for (const FeedMessage& m : drain_feed(receiver)) {
+        if (m.type == MessageType::SnapshotBegin) {
+            book.clear();
+        } else if (m.type == MessageType::LevelDelete) {
+            book.erase(m.price);
+        } else if (m.type != MessageType::Trade && m.type != MessageType::SnapshotEnd) {
+            book[m.price] = m.quantity;
+        }
+    }
+    BOOST_CHECK(book == expected);
+
+    auto stats = publisher.stats();
+    BOOST_TEST_MESSAGE("ring full " << stats.ring_full << " snapshots " << stats.snapshots);
+    if (stats.ring_full > 0) {
+        BOOST_CHECK_GE(stats.snapshots, 1u);  // Published on recovery
+    }
+    BOOST_CHECK_LE(stats.trades_dropped, 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(L3BookBuilderTests)
+
+using L3Builder = hft::L3BookBuilder<double, int64_t>;
+using L3Update = hft::OrderUpdate<double, int64_t>;
+
+static L3Update l3_event(hft::OrderEventType type, uint64_t ref, double price = 0, int64_t quantity = 0,
+                         bool is_buy = true, uint64_t new_ref = 0) {
+    return {.type = type, .symbol = 3, .order_ref = ref, .new_order_ref = new_ref, .price = price,
+            .quantity = quantity, .is_buy = is_buy, .timestamp = std::chrono::nanoseconds(0)};
+}
+
+BOOST_AUTO_TEST_CASE(test_add_execute_cancel_delete) {
+    L3Builder builder(64);
+    using hft::OrderEventType;
+
+    BOOST_CHECK(builder.apply(l3_event(OrderEventType::Add, 10, 100.0, 300)));
+    BOOST_CHECK(builder.apply(l3_event(OrderEventType::Add, 11, 100.0, 200)));
+    BOOST_CHECK(builder.apply(l3_event(OrderEventType::Add, 12, 99.0, 50)));
+    BOOST_CHECK(builder.apply(l3_event(OrderEventType::Add, 20, 101.0, 70, false)));
+
+    const auto& book = builder.book(3);
+    BOOST_CHECK_EQUAL(book.best_bid(), 100.0);
+    BOOST_CHECK_EQUAL(book.best_ask(), 101.0);
+    BOOST_CHECK_EQUAL(book.volume_at_price(true, 100.0), 500);
+
+    auto bids = book.depth(true, 5);
+    BOOST_REQUIRE_EQUAL(bids.size(), 2u);
+    BOOST_CHECK_EQUAL(bids[0].order_count, 2u);
+    BOOST_CHECK_EQUAL(bids[1].price, 99.0);
+
+    BOOST_CHECK(builder.apply(l3_event(OrderEventType::Execute, 10, 0, 100)));
+    BOOST_CHECK(builder.apply(l3_event(OrderEventType::Cancel, 11, 0, 50)));
+    BOOST_CHECK_EQUAL(book.volume_at_price(true, 100.0), 350);
+
+    // Executing the remainder removes the order; deleting the last one removes the level
+    BOOST_CHECK(builder.apply(l3_event(OrderEventType::Execute, 10, 0, 200)));
+    BOOST_CHECK(builder.apply(l3_event(OrderEventType::Delete, 11)));
+    BOOST_CHECK_EQUAL(book.best_bid(), 99.0);
+    BOOST_CHECK_EQUAL(builder.live_orders(), 2u);
+
+    BOOST_CHECK(!builder.apply(l3_event(OrderEventType::Delete, 11)));
+    BOOST_CHECK_EQUAL(builder.stats().unknown_orders, 1u);
+    BOOST_CHECK(!builder.apply(l3_event(OrderEventType::Add, 12, 98.0, 10)));
+    BOOST_CHECK_EQUAL(builder.stats().duplicate_orders, 1u);
+}
+
+BOOST_AUTO_TEST_CASE(test_rejects_bad_symbols_and_quantities) {
+    L3Builder builder(64, 4, 16);
+    using hft::OrderEventType;
+
+    for (uint32_t symbol : {16u, UINT32_MAX}) {
+        auto add = l3_event(OrderEventType::Add, symbol, 100.0, 10);
+        add.symbol = symbol;
+        BOOST_CHECK(!builder.apply(add));
+    }
+    BOOST_CHECK_EQUAL(builder.stats().unknown_orders, 2u);
+    BOOST_CHECK_EQUAL(builder.live_orders(), 0u);
+    BOOST_CHECK_THROW(builder.book(0), std::out_of_range);
+
+    BOOST_REQUIRE(builder.apply(l3_event(OrderEventType::Add, 1, 100.0, 10)));
+    BOOST_CHECK(!builder.apply(l3_event(OrderEventType::Execute, 1, 0, -5)));
+    BOOST_CHECK(!builder.apply(l3_event(OrderEventType::Cancel, 1, 0, 0)));
+    BOOST_CHECK_EQUAL(builder.stats().bad_quantities, 2u);
+    BOOST_CHECK_EQUAL(builder.book(3).volume_at_price(true, 100.0), 10);
+}
+
+BOOST_AUTO_TEST_CASE(test_replace_loses_priority) {
+    L3Builder builder(64);
+    using hft::OrderEventType;
+
+    builder.apply(l3_event(OrderEventType::Add, 1, 100.0, 10));
+    builder.apply(l3_event(OrderEventType::Add, 2, 100.0, 20));
+    builder.apply(l3_event(OrderEventType::Add, 3, 100.0, 30));
+    BOOST_CHECK(builder.apply(l3_event(OrderEventType::Replace, 1, 100.0, 15, true, 4)));
+
+    auto queue = builder.orders_at(3, true, 100.0);
+    BOOST_REQUIRE_EQUAL(queue.size(), 3u);
+    BOOST_CHECK_EQUAL(queue[0].order_ref, 2u);
+    BOOST_CHECK_EQUAL(queue[1].order_ref, 3u);
+    BOOST_CHECK_EQUAL(queue[2].order_ref, 4u);
+    BOOST_CHECK_EQUAL(queue[2].quantity, 15);
+    BOOST_CHECK_EQUAL(builder.book(3).volume_at_price(true, 100.0), 65);
+
+    // Replace keeps the side and can move price
+    BOOST_CHECK(builder.apply(l3_event(OrderEventType::Replace, 2, 101.0, 20, false, 5)));
+    BOOST_CHECK_EQUAL(builder.book(3).best_bid(), 101.0);
+}
+
+BOOST_AUTO_TEST_CASE(test_order_table_growth) {
+    // Deliberately undersized so the table has to grow and shift entries on erase
+    L3Builder builder(16);
+    using hft::OrderEventType;
+
+    for (uint64_t ref = 1; ref <= 20000; ref++) {
+        builder.apply(l3_event(OrderEventType::Add, ref * 7919, 100.0 - (ref % 50) * 0.01, 1));
+    }
+    BOOST_CHECK_EQUAL(builder.live_orders(), 20000u);
+
+    for (uint64_t ref = 1; ref <= 20000; ref += 2) {
+        BOOST_CHECK(builder.apply(l3_event(OrderEventType::Delete, ref * 7919)));
+    }
+    bool all_found = true;
+    for (uint64_t ref = 2; ref <= 20000; ref += 2) {
+        all_found &= builder.apply(l3_event(OrderEventType::Execute, ref * 7919, 0, 1));
+    }
+    BOOST_CHECK(all_found);
+    BOOST_CHECK_EQUAL(builder.live_orders(), 0u);
+    BOOST_CHECK_EQUAL(builder.book(3).bid_levels(), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(BacktesterTests)
+
+// Buys one lot off the first offer it sees and sells it into the next bid
+struct RoundTripStrategy {
+    void on_market_update(const hft::RecordedUpdate& update, hft::BacktestContext& context) {
+        if (!update.is_buy && !bought) {
+            bought = context.submit(update.price, 1, true);
+        } else if (update.is_buy && bought && context.position() > 0) {
+            context.submit(update.price, 1, false);
+        }
+    }
+    void on_fill(const hft::StrategyFill&, hft::BacktestContext&) { fills_seen++; }
+
+    bool bought = false;
+    int fills_seen = 0;
+};
+
+struct SessionDirectory {
+    SessionDirectory() {
+        root = std::filesystem::temp_directory_path() / ("hft-backtest-" + std::to_string(::getpid()));
+        std::filesystem::remove_all(root);
+    }
+    ~SessionDirectory() { std::filesystem::remove_all(root); }
+
+    void write(const std::string& day, const std::string& symbol, const std::vector<hft::RecordedUpdate>& tape) {
+        std::filesystem::create_directories(root / day);
+        hft::write_session_file(root / day / (symbol + ".bin"), tape);
+    }
+
+    std::filesystem::path root;
+};
+
+static std::vector<hft::RecordedUpdate> round_trip_tape(double buy_at, double sell_at) {
+    return {
+        {.price = buy_at, .quantity = 10, .is_buy = false, .timestamp = std::chrono::nanoseconds(1)},
+        {.price = sell_at, .quantity = 10, .is_buy = true, .timestamp = std::chrono::nanoseconds(2)},
+    };
+}
+
+BOOST_AUTO_TEST_CASE(test_session_file_round_trip) {
+    SessionDirectory dir;
+    auto tape = round_trip_tape(100.0, 101.0);
+    dir.write("2024-01-02", "AAA", tape);
+
+    hft::SessionReader reader(dir.root / "2024-01-02" / "AAA.bin");
+    BOOST_REQUIRE_EQUAL(reader.updates().size(), 2u);
+    BOOST_CHECK_EQUAL(reader.updates()[1].price, 101.0);
+    BOOST_CHECK(reader.updates()[1].is_buy);
+}
+
+BOOST_AUTO_TEST_CASE(test_session_file_rejects_oversized_count) {
+    SessionDirectory dir;
+    dir.write("2024-01-02", "AAA", round_trip_tape(100.0, 101.0));
+    auto path = dir.root / "2024-01-02" / "AAA.bin";
+
+    // A count whose byte size wraps to something small must still be caught
+    hft::SessionFileHeader header{{'H', 'F', 'T', 'S'}, hft::kSessionFileVersion, (1ull << 59) + 1};
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+
+    BOOST_CHECK_THROW(hft::SessionReader{path}, std::runtime_error);
+}
+
+BOOST_AUTO_TEST_CASE(test_session_file_zeroes_padding) {
+    SessionDirectory dir;
+    std::vector<hft::RecordedUpdate> tape(2);
+    std::memset(static_cast<void*>(tape.data()), 0xAB, tape.size() * sizeof(hft::RecordedUpdate));
+    for (auto& update : tape) {
+        update.price     = 100.0;
+        update.quantity  = 10;
+        update.is_buy    = true;
+        update.timestamp = std::chrono::nanoseconds(1);
+    }
+    dir.write("2024-01-02", "AAA", tape);
+
+    std::ifstream file(dir.root / "2024-01-02" / "AAA.bin", std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    BOOST_REQUIRE_EQUAL(bytes.size(), sizeof(hft::SessionFileHeader) + 2 * sizeof(hft::RecordedUpdate));
+    for (size_t r = 0; r < 2; ++r) {
+        size_t record = sizeof(hft::SessionFileHeader) + r * sizeof(hft::RecordedUpdate);
+        for (size_t i = offsetof(hft::RecordedUpdate, is_buy) + 1; i < offsetof(hft::RecordedUpdate, timestamp); ++i) {
+            BOOST_CHECK_EQUAL(bytes[record + i], 0);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_parallel_run_merges_sessions) {
+    SessionDirectory dir;
+    dir.write("2024-01-02", "AAA", round_trip_tape(100.0, 101.0));
+    dir.write("2024-01-02", "BBB", round_trip_tape(50.0, 49.5));
+    dir.write("2024-01-03", "AAA", round_trip_tape(100.0, 100.25));
+    dir.write("2024-01-03", "CCC", {});
+
+    hft::Backtester<RoundTripStrategy> backtester({.root = dir.root, .threads = 4},
+                                                  [](const hft::SessionTask&) { return RoundTripStrategy{}; });
+    auto summary = backtester.run();
+
+    BOOST_REQUIRE_EQUAL(summary.sessions.size(), 4u);
+    BOOST_CHECK_EQUAL(summary.sessions[0].day, "2024-01-02");
+    BOOST_CHECK_EQUAL(summary.sessions[1].symbol, "BBB");
+    BOOST_CHECK_CLOSE(summary.sessions[0].pnl(), 1.0, 1e-9);
+    BOOST_CHECK_CLOSE(summary.sessions[1].pnl(), -0.5, 1e-9);
+    BOOST_CHECK_EQUAL(summary.sessions[0].position, 0);
+    BOOST_CHECK_EQUAL(summary.sessions[3].updates, 0u);
+
+    BOOST_CHECK_EQUAL(summary.fills, 6u);
+    BOOST_CHECK_EQUAL(summary.updates, 6u);
+    BOOST_CHECK_CLOSE(summary.pnl, 0.75, 1e-9);
+
+    // Same answer single threaded: tasks share no state
+    hft::Backtester<RoundTripStrategy> serial({.root = dir.root, .threads = 1},
+                                              [](const hft::SessionTask&) { return RoundTripStrategy{}; });
+    BOOST_CHECK_CLOSE(serial.run().pnl, summary.pnl, 1e-9);
+}
+
+BOOST_AUTO_TEST_CASE(test_largest_sessions_start_first) {
+    SessionDirectory dir;
+    dir.write("2024-01-02", "AAA", round_trip_tape(100.0, 101.0));
+    dir.write("2024-01-02", "BBB", std::vector<hft::RecordedUpdate>(6, round_trip_tape(50.0, 49.5)[0]));
+    dir.write("2024-01-02", "CCC", {});
+    dir.write("2024-01-02", "DDD", std::vector<hft::RecordedUpdate>(4, round_trip_tape(50.0, 49.5)[0]));
+
+    std::vector<std::string> started;
+    hft::Backtester<RoundTripStrategy> backtester({.root = dir.root, .threads = 1},
+                                                  [&started](const hft::SessionTask& task) {
+                                                      started.push_back(task.symbol);
+                                                      return RoundTripStrategy{};
+                                                  });
+    backtester.run();
+
+    std::vector<std::string> expected{"BBB", "DDD", "AAA", "CCC"};
+    BOOST_CHECK_EQUAL_COLLECTIONS(started.begin(), started.end(), expected.begin(), expected.end());
+}
+
+// Tries to lift far more than the offer shows, twice on the same update
+struct GreedyStrategy {
+    void on_market_update(const hft::RecordedUpdate& update, hft::BacktestContext& context) {
+        if (!update.is_buy && !tried) {
+            tried = true;
+            first = context.submit(update.price, 100, true);
+            second = context.submit(update.price, 100, true);
+        }
+    }
+
+    bool tried = false;
+    bool first = false;
+    bool second = false;
+};
+
+BOOST_AUTO_TEST_CASE(test_fills_capped_by_tape_liquidity) {
+    SessionDirectory dir;
+    dir.write("2024-01-02", "AAA", round_trip_tape(100.0, 101.0));
+
+    hft::Backtester<GreedyStrategy> backtester({.root = dir.root, .threads = 1},
+                                               [](const hft::SessionTask&) { return GreedyStrategy{}; });
+    auto result = backtester.run_session(hft::discover_sessions(dir.root).front());
+
+    BOOST_CHECK_EQUAL(result.orders, 2u);
+    BOOST_CHECK_EQUAL(result.fills, 1u);  // The second lift finds the offer used up
+    BOOST_CHECK_EQUAL(result.volume, 10);
+    BOOST_CHECK_EQUAL(result.position, 10);
+    BOOST_CHECK_CLOSE(result.cash, -1000.0, 1e-9);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(TickStoreTests)
+
+static std::filesystem::path tick_file_path(const std::string& name) {
+    return std::filesystem::temp_directory_path() / ("hft-ticks-" + std::to_string(::getpid()) + "-" + name);
+}
+
+// Random-walk tape with one update per microsecond, jittered
+static std::vector<hft::RecordedUpdate> synthetic_tape(size_t count) {
+    std::vector<hft::RecordedUpdate> tape;
+    tape.reserve(count);
+    uint64_t state = 88172645463325252ull;
+    auto next = [&state] {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    };
+    int64_t ticks = 1000000;
+    for (size_t i = 0; i < count; ++i) {
+        ticks += static_cast<int64_t>(next() % 5) - 2;
+        tape.push_back({.price = hft::protocol::from_ticks(ticks),
+                        .quantity = static_cast<int64_t>(next() % 1000) + 1,
+                        .is_buy = (next() & 1) != 0,
+                        .timestamp = std::chrono::nanoseconds(1'000'000'000 + i * 1000 + next() % 100)});
+    }
+    return tape;
+}
+
+static bool same_update(const hft::RecordedUpdate& a, const hft::RecordedUpdate& b) {
+    return a.price == b.price && a.quantity == b.quantity && a.is_buy == b.is_buy && a.timestamp == b.timestamp;
+}
+
+BOOST_AUTO_TEST_CASE(test_pack_unpack_every_width) {
+    std::vector<uint64_t> values(2 * hft::columnar::kGroupSize);
+    std::vector<uint64_t> packed(2 * hft::columnar::kGroupSize);
+    std::vector<uint64_t> unpacked(values.size());
+    uint64_t seed = 1;
+    for (unsigned width = 0; width <= 64; ++width) {
+        uint64_t mask = width == 64 ? ~0ull : (1ull << width) - 1;
+        for (uint64_t& v : values) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            v = seed & mask;
+        }
+        hft::columnar::pack(values.data(), 2, width, packed.data());
+        hft::columnar::unpack(packed.data(), 2, width, unpacked.data());
+        BOOST_REQUIRE_MESSAGE(unpacked == values, "width " << width);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_column_round_trip_extremes) {
+    std::vector<int64_t> values = {0, INT64_MAX, INT64_MIN, -1, 1, INT64_MIN, 42, -42, INT64_MAX, 7};
+    for (auto encoding : {hft::columnar::ColumnEncoding::Delta, hft::columnar::ColumnEncoding::FrameOfReference}) {
+        std::vector<uint64_t> encoded;
+        hft::columnar::encode_column(encoding, values.data(), values.size(), encoded);
+        std::vector<int64_t> decoded(hft::columnar::padded_count(values.size()));
+        const uint64_t* end = hft::columnar::decode_column(encoded.data(), values.size(), decoded.data());
+        BOOST_CHECK(end == encoded.data() + encoded.size());
+        BOOST_CHECK(std::equal(values.begin(), values.end(), decoded.begin()));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(test_market_update_round_trip) {
+    auto path = tick_file_path("updates.htc");
+    auto tape = synthetic_tape(10000);
+    {
+        hft::TickWriter<hft::RecordedUpdate> writer(path, 1024);
+        writer.append(tape);
+        writer.close();
+        BOOST_CHECK_EQUAL(writer.records(), tape.size());
+    }
+
+    hft::TickReader<hft::RecordedUpdate> reader(path);
+    BOOST_CHECK_EQUAL(reader.record_count(), tape.size());
+    BOOST_REQUIRE_EQUAL(reader.blocks().size(), 10u);
+    BOOST_CHECK_EQUAL(reader.blocks().back().count, 10000u - 9 * 1024);
+
+    auto decoded = reader.read_all();
+    BOOST_REQUIRE_EQUAL(decoded.size(), tape.size());
+    BOOST_CHECK(std::equal(tape.begin(), tape.end(), decoded.begin(), same_update));
+
+    // Small deltas and quantities pack far below the raw 32 bytes a record
+    BOOST_CHECK_LT(reader.file_size() * 4, tape.size() * sizeof(hft::RecordedUpdate));
+
+    auto quantities = reader.column(3, 2);
+    BOOST_REQUIRE_EQUAL(quantities.size(), 1024u);
+    BOOST_CHECK_EQUAL(quantities[5], tape[3 * 1024 + 5].quantity);
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_range_query_skips_blocks) {
+    auto path = tick_file_path("range.htc");
+    auto tape = synthetic_tape(8192);
+    {
+        hft::TickWriter<hft::RecordedUpdate> writer(path, 512);
+        writer.append(tape);
+    }
+
+    hft::TickReader<hft::RecordedUpdate> reader(path);
+    auto from = tape[2100].timestamp;
+    auto to = tape[2200].timestamp;
+
+    std::vector<hft::RecordedUpdate> hits;
+    size_t decoded = reader.scan(from, to, [&hits](const hft::RecordedUpdate& u) { hits.push_back(u); });
+    BOOST_CHECK_EQUAL(decoded, 1u);  // Rows 2100-2200 sit inside block 4
+    BOOST_REQUIRE_EQUAL(hits.size(), 101u);
+    BOOST_CHECK(same_update(hits.front(), tape[2100]));
+    BOOST_CHECK(same_update(hits.back(), tape[2200]));
+
+    BOOST_CHECK(reader.query(std::chrono::nanoseconds(0), std::chrono::nanoseconds(1)).empty());
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_fill_stream_round_trip) {
+    auto path = tick_file_path("fills.htc");
+    std::vector<hft::FillRecord> fills;
+    for (uint64_t i = 0; i < 700; ++i) {
+        fills.push_back({1000 + i * 3, 99.5 + static_cast<double>(i % 7) * 0.01, static_cast<int64_t>(i % 50) + 1,
+                         std::chrono::nanoseconds(5'000 + i * 250)});
+    }
+    {
+        hft::TickWriter<hft::FillRecord> writer(path, 256);
+        writer.append(fills);
+    }
+
+    hft::TickReader<hft::FillRecord> reader(path);
+    auto decoded = reader.read_all();
+    BOOST_REQUIRE_EQUAL(decoded.size(), fills.size());
+    for (size_t i = 0; i < fills.size(); ++i) {
+        BOOST_CHECK_EQUAL(decoded[i].order_id, fills[i].order_id);
+        BOOST_CHECK_EQUAL(decoded[i].price, fills[i].price);
+        BOOST_CHECK_EQUAL(decoded[i].quantity, fills[i].quantity);
+        BOOST_CHECK(decoded[i].timestamp == fills[i].timestamp);
+    }
+
+    // A fill file is not a market update file
+    BOOST_CHECK_THROW(hft::TickReader<hft::RecordedUpdate>{path}, std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_price_scale_round_trip) {
+    auto path = tick_file_path("scale.htc");
+    std::vector<hft::RecordedUpdate> tape = {
+        {.price = 100.0001, .quantity = 1, .is_buy = true, .timestamp = std::chrono::nanoseconds(1)},
+        {.price = 100.00005, .quantity = 2, .is_buy = false, .timestamp = std::chrono::nanoseconds(2)},
+    };
+    {
+        // Half a protocol tick does not survive the default scale
+        hft::TickWriter<hft::RecordedUpdate> writer(path);
+        writer.append(tape);
+        BOOST_CHECK_EQUAL(writer.inexact_prices(), 1u);
+    }
+    {
+        hft::TickWriter<hft::RecordedUpdate> writer(path, hft::kDefaultTickBlockSize, 100'000);
+        writer.append(tape);
+        BOOST_CHECK_EQUAL(writer.inexact_prices(), 0u);
+    }
+
+    hft::TickReader<hft::RecordedUpdate> reader(path);
+    auto decoded = reader.read_all();
+    BOOST_REQUIRE_EQUAL(decoded.size(), tape.size());
+    BOOST_CHECK(std::equal(tape.begin(), tape.end(), decoded.begin(), same_update));
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_corrupt_column_width_rejected) {
+    auto path = tick_file_path("corrupt.htc");
+    {
+        hft::TickWriter<hft::RecordedUpdate> writer(path, 1024);
+        writer.append(synthetic_tape(100));
+    }
+
+    // A 64-bit width claims far more words than the block holds
+    uint64_t word = static_cast<uint64_t>(hft::columnar::ColumnEncoding::Delta) | (uint64_t{64} << 8);
+    {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(sizeof(hft::TickFileHeader));
+        file.write(reinterpret_cast<const char*>(&word), sizeof(word));
+    }
+    BOOST_CHECK_THROW(hft::TickReader<hft::RecordedUpdate>{path}, std::runtime_error);
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(test_corrupt_header_counts_rejected) {
+    auto path = tick_file_path("header.htc");
+    {
+        hft::TickWriter<hft::RecordedUpdate> writer(path, 64);
+        writer.append(synthetic_tape(200));
+    }
+    hft::TickFileHeader good;
+    {
+        std::ifstream file(path, std::ios::binary);
+        file.read(reinterpret_cast<char*>(&good), sizeof(good));
+    }
+    auto rewrite = [&](const hft::TickFileHeader& header) {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    };
+
+    // More records than the blocks hold would leave read_all() short
+    hft::TickFileHeader header = good;
+    header.record_count += 1;
+    rewrite(header);
+    BOOST_CHECK_THROW(hft::TickReader<hft::RecordedUpdate>{path}, std::runtime_error);
+
+    // An index that is not word aligned can't be read in place
+    header = good;
+    header.index_offset -= 4;
+    rewrite(header);
+    BOOST_CHECK_THROW(hft::TickReader<hft::RecordedUpdate>{path}, std::runtime_error);
+
+    rewrite(good);
+    BOOST_CHECK_EQUAL(hft::TickReader<hft::RecordedUpdate>{path}.read_all().size(), 200u);
+    std::filesystem::remove(path);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(EngineIngressTests)
+
+using TestEngine = hft::MatchingEngine<double, int64_t, uint64_t>;
+using TestIngress = hft::EngineIngress<double, int64_t, uint64_t>;
+using TestOrder = hft::OrderBook<double, int64_t, uint64_t>::Order;
+
+static TestOrder ingress_order(uint64_t id, double price = 100.0, bool is_buy = true) {
+    return {.id = id, .price = price, .quantity = 10, .is_buy = is_buy, .timestamp = std::chrono::nanoseconds(0)};
+}
+
+// Makes every book change cost a fixed amount of engine time
+static void slow_down(TestEngine& engine, std::chrono::nanoseconds cost) {
+    engine.set_level_callback([cost](hft::LevelAction, bool, double, int64_t) {
+        auto until = std::chrono::steady_clock::now() + cost;
+        while (std::chrono::steady_clock::now() < until) {
+        }
+    });
+}
+
+BOOST_AUTO_TEST_CASE(test_cancels_overtake_queued_orders) {
+    TestEngine engine;
+    TestIngress ingress(engine);
+    auto source = ingress.add_source();
+
+    BOOST_CHECK(ingress.submit(source, ingress_order(1)) == hft::Admission::Accepted);
+    ingress.poll();
+
+    ingress.submit(source, ingress_order(2));
+    ingress.cancel(source, 1);
+    ingress.cancel(source, 2);  // Runs before order 2 reaches the engine
+    ingress.poll();
+
+    auto stats = ingress.stats();
+    BOOST_CHECK_EQUAL(stats.cancels, 2u);
+    BOOST_CHECK_EQUAL(stats.executed, 1u);
+    BOOST_CHECK_EQUAL(stats.withdrawn, 1u);
+    BOOST_CHECK_EQUAL(stats.depth, 0u);
+    BOOST_CHECK_THROW(engine.cancel_order(1), std::runtime_error);
+    BOOST_CHECK_THROW(engine.cancel_order(2), std::runtime_error);  // Never entered the book
+}
+
+BOOST_AUTO_TEST_CASE(test_round_robin_limits_flooding_source) {
+    TestEngine engine;
+    TestIngress ingress(engine, {.queue_capacity = 1024, .batch_per_source = 16});
+    auto flood = ingress.add_source();
+    auto quiet = ingress.add_source();
+
+    for (uint64_t id = 1; id <= 500; ++id) {
+        ingress.submit(flood, ingress_order(id));
+    }
+    for (uint64_t id = 1001; id <= 1010; ++id) {
+        ingress.submit(quiet, ingress_order(id));
+    }
+    ingress.poll();
+
+    BOOST_CHECK_EQUAL(ingress.source_stats(flood).executed, 16u);
+    BOOST_CHECK_EQUAL(ingress.source_stats(quiet).executed, 10u);
+    BOOST_CHECK_EQUAL(ingress.source_stats(flood).depth, 484u);
+    BOOST_CHECK_EQUAL(ingress.stats().depth, 484u);
+    BOOST_CHECK_EQUAL(ingress.stats().peak_depth, 510u);  // Sampled before the round drained
+}
+
+BOOST_AUTO_TEST_CASE(test_stopped_ingress_refuses_work) {
+    TestEngine engine;
+    TestIngress ingress(engine);
+    auto source = ingress.add_source();
+
+    ingress.start();
+    BOOST_CHECK_THROW(ingress.poll(), std::logic_error);  // The worker owns the queues
+    BOOST_CHECK(ingress.submit(source, ingress_order(1)) == hft::Admission::Accepted);
+    ingress.stop();
+    BOOST_CHECK_EQUAL(ingress.stats().executed, 1u);
+
+    // Nothing would ever drain these, so they must not be reported accepted
+    BOOST_CHECK(ingress.submit(source, ingress_order(2)) == hft::Admission::RejectedStopped);
+    BOOST_CHECK(ingress.cancel(source, 1) == hft::Admission::RejectedStopped);
+    BOOST_CHECK_EQUAL(ingress.poll(), 0u);
+
+    ingress.start();
+    BOOST_CHECK(ingress.submit(source, ingress_order(3)) == hft::Admission::Accepted);
+    ingress.stop();
+    BOOST_CHECK_EQUAL(ingress.stats().executed, 2u);
+}
+
+BOOST_AUTO_TEST_CASE(test_overload_rejects_only_sources_over_fair_share) {
+    TestEngine engine;
+    TestIngress ingress(engine, {.queue_capacity = 128, .high_watermark = 64, .low_watermark = 8});
+    auto flood = ingress.add_source();
+    auto quiet = ingress.add_source();
+
+    // The flooder is cut off at its share without waiting for a poll; the
+    // quiet source's share stays reserved, so depth never passes the watermark
+    uint64_t accepted = 0;
+    while (ingress.submit(flood, ingress_order(accepted + 1)) == hft::Admission::Accepted) {
+        ++accepted;
+    }
+    BOOST_CHECK_EQUAL(accepted, 32u);
+    BOOST_CHECK(ingress.stats().overloaded);
+
+    BOOST_CHECK(ingress.submit(quiet, ingress_order(1001)) == hft::Admission::Accepted);
+    BOOST_CHECK(ingress.cancel(flood, 1) == hft::Admission::Accepted);
+
+    ingress.poll();
+    BOOST_CHECK(ingress.stats().overloaded);  // Still above the low watermark
+
+    // While overloaded the flooder only refills up to its share
+    uint64_t refilled = 0;
+    while (ingress.submit(flood, ingress_order(100 + refilled)) == hft::Admission::Accepted) {
+        ++refilled;
+    }
+    BOOST_CHECK_EQUAL(refilled, 16u);
+
+    while (ingress.poll() > 0) {
+    }
+    auto stats = ingress.stats();
+    BOOST_CHECK(!stats.overloaded);
+    BOOST_CHECK_EQUAL(stats.overload_episodes, 1u);
+    BOOST_CHECK_EQUAL(stats.rejected_overload, 2u);
+    BOOST_CHECK_EQUAL(stats.executed, 48u);  // 47 of the flooder's plus the quiet source's
+    BOOST_CHECK_EQUAL(stats.withdrawn, 1u);
+    BOOST_CHECK_LE(stats.peak_depth, 64u);
+    BOOST_CHECK(ingress.submit(flood, ingress_order(201)) == hft::Admission::Accepted);
+}
+
+// Two producers submit far faster than the engine can absorb. Every order
+// is stamped just before submit and crosses a resting ask, so the fill
+// callback measures its delay end to end without trusting the ingress's own
+// bookkeeping.
+struct SaturationRun {
+    hft::IngressStats    stats;
+    std::vector<int64_t> delays_ns;  // Sorted, one per executed order
+
+    std::chrono::nanoseconds quantile(double q) const {
+        if (delays_ns.empty()) {
+            return std::chrono::nanoseconds(0);
+        }
+        return std::chrono::nanoseconds(delays_ns[static_cast<size_t>(q * static_cast<double>(delays_ns.size() - 1))]);
+    }
+};
+
+// End-to-end tails are asserted against the bound the ingress itself
+// enforces plus a fixed preemption allowance. When the producers share the
+// worker's core, time the worker spends descheduled is invisible to
+// admission: each runnable producer can hold the core for one scheduler
+// slice (0.75ms base slice under EEVDF, rounded up to a 1ms tick) before the
+// worker runs again.
+static constexpr size_t kSaturationProducers = 2;
+
+static std::chrono::nanoseconds with_preemption(std::chrono::nanoseconds bound) {
+    return bound + std::chrono::milliseconds(1) * kSaturationProducers;
+}
+
+static int64_t steady_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static SaturationRun saturate(TestEngine& engine, TestIngress& ingress, size_t orders_per_source) {
+    constexpr uint64_t kSources = kSaturationProducers;
+    constexpr uint64_t kIdStride = 1'000'000;
+
+    // Written by a producer before the push that publishes the order
+    std::vector<std::vector<int64_t>> submitted(kSources, std::vector<int64_t>(orders_per_source));
+    SaturationRun run;
+    run.delays_ns.reserve(kSources * orders_per_source);
+    engine.handle_order(ingress_order((kSources + 1) * kIdStride, 90.0, false));
+    engine.set_fill_callback([&](uint64_t id, double, int64_t) {
+        run.delays_ns.push_back(steady_ns() - submitted[id / kIdStride - 1][id % kIdStride]);
+    });
+
+    // Register every source first so no producer starts with the whole watermark as its share
+    std::vector<TestIngress::SourceId> sources;
+    for (uint64_t p = 0; p < kSources; ++p) {
+        sources.push_back(ingress.add_source());
+    }
+    std::vector<std::thread> producers;
+    for (uint64_t p = 0; p < kSources; ++p) {
+        producers.emplace_back([&ingress, &submitted, source = sources[p], p, orders_per_source] {
+            for (uint64_t i = 0; i < orders_per_source; ++i) {
+                double price = 100.0 - static_cast<double>(i % 50) * 0.01;
+                submitted[p][i] = steady_ns();
+                if (ingress.submit(source, ingress_order((p + 1) * kIdStride + i, price)) != hft::Admission::Accepted) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    ingress.start();
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    ingress.stop();
+    engine.set_fill_callback(nullptr);
+
+    run.stats = ingress.stats();
+    std::sort(run.delays_ns.begin(), run.delays_ns.end());
+    return run;
+}
+
+BOOST_AUTO_TEST_CASE(test_saturation_keeps_admitted_latency_bounded) {
+    TestEngine engine;
+    slow_down(engine, std::chrono::microseconds(5));
+    TestIngress ingress(engine, {.queue_capacity = 4096, .high_watermark = 256, .low_watermark = 64});
+
+    auto run = saturate(engine, ingress, 20000);
+    BOOST_TEST_MESSAGE("executed " << run.stats.executed << " rejected " << run.stats.rejected_overload
+                                   << " peak " << run.stats.peak_depth << " p99 " << run.quantile(0.99).count()
+                                   << "ns, ingress p99 " << ingress.queue_delay_quantile(0.99).count() << "ns");
+
+    BOOST_CHECK_GT(run.stats.rejected_overload, 0u);
+    BOOST_CHECK_EQUAL(run.stats.executed, run.stats.admitted);
+    BOOST_CHECK_EQUAL(run.delays_ns.size(), run.stats.executed);
+    BOOST_CHECK_EQUAL(run.stats.depth, 0u);
+    // Depth is sampled before each drain, so it sees the queues at their
+    // fullest. Each source is held to its share of the watermark.
+    BOOST_CHECK_LE(run.stats.peak_depth, 256u);
+    BOOST_CHECK_GE(run.stats.peak_depth, 128u);
+    // An admitted order waits behind at most the watermark's worth of orders
+    // at 5us each, ~1.3ms; the queues alone would allow 41ms
+    auto budget = std::chrono::microseconds(5) * 256;
+    BOOST_CHECK_LT(run.quantile(0.99), with_preemption(budget));
+}
+
+BOOST_AUTO_TEST_CASE(test_shed_stale_caps_queue_delay) {
+    TestEngine engine;
+    slow_down(engine, std::chrono::microseconds(5));
+    TestIngress ingress(engine, {.queue_capacity = 4096,
+                                 .policy = hft::OverloadPolicy::ShedStale,
+                                 .max_queue_delay = std::chrono::microseconds(500)});
+
+    auto run = saturate(engine, ingress, 20000);
+    BOOST_TEST_MESSAGE("executed " << run.stats.executed << " shed " << run.stats.shed << " p99 "
+                                   << run.quantile(0.99).count() << "ns, max " << run.delays_ns.back() << "ns");
+
+    BOOST_CHECK_GT(run.stats.shed, 0u);
+    BOOST_CHECK_EQUAL(run.stats.executed + run.stats.shed, run.stats.admitted);
+    BOOST_CHECK_EQUAL(run.delays_ns.size(), run.stats.executed);
+    BOOST_CHECK_LE(run.stats.max_queue_delay_ns, 500'000u);
+    // Executed orders waited at most the limit plus their own service time
+    BOOST_CHECK_LT(run.quantile(0.99), with_preemption(std::chrono::microseconds(500 + 5)));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(ThreadServicesTests)
+
+BOOST_AUTO_TEST_CASE(test_thread_order_ids_unique_across_threads) {
+    constexpr size_t kThreads = 4;
+    constexpr size_t kIds = 5000;
+    std::vector<std::vector<uint64_t>> ids(kThreads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < kThreads; ++t) {
+        threads.emplace_back([&ids, t] {
+            hft::utils::OrderIdBlock block(64);
+            for (size_t i = 0; i < kIds; ++i) {
+                // Mix all three sources; they share one counter
+                uint64_t id = i % 3 == 0   ? hft::utils::thread_order_id()
+                              : i % 3 == 1 ? block.next()
+                                           : hft::utils::generate_order_id();
+                ids[t].push_back(id);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<uint64_t> all;
+    for (const auto& per_thread : ids) {
+        // Each source hands out increasing IDs within a thread
+        for (size_t i = 3; i < per_thread.size(); ++i) {
+            BOOST_REQUIRE_GT(per_thread[i], per_thread[i - 3]);
+        }
+        all.insert(all.end(), per_thread.begin(), per_thread.end());
+    }
+    std::sort(all.begin(), all.end());
+    BOOST_CHECK(std::adjacent_find(all.begin(), all.end()) == all.end());
+    BOOST_CHECK_GT(all.front(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(test_thread_clock_tracks_system_clock) {
+    auto& clock = hft::utils::ThreadClock::local();
+    auto previous = clock.now();
+    for (int i = 0; i < 100000; ++i) {
+        auto now = clock.now();
+        BOOST_REQUIRE(now >= previous);
+        previous = now;
+    }
+
+    // Two back-to-back reads can still straddle a preemption, so keep the
+    // closest of a few attempts
+    auto fine_error = std::chrono::nanoseconds::max();
+    auto coarse_error = std::chrono::nanoseconds::max();
+    for (int attempt = 0; attempt < 5; ++attempt) {
+        auto fine = clock.now();
+        auto reference = hft::utils::current_time();
+        auto coarse = hft::utils::ThreadClock::coarse();
+        fine_error = std::min(fine_error, std::chrono::abs(reference - fine));
+        coarse_error = std::min(coarse_error, std::chrono::abs(reference - coarse));
+        std::this_thread::yield();
+    }
+    BOOST_CHECK_LT(fine_error, std::chrono::milliseconds(1));
+    BOOST_CHECK_LT(coarse_error, std::chrono::milliseconds(50));
+}
+
+BOOST_AUTO_TEST_CASE(test_stamp_batch_with_one_read) {
+    std::vector<hft::OrderBook<double, int64_t, uint64_t>::Order> batch(8);
+    hft::utils::ThreadClock::local().stamp(batch);
+    BOOST_CHECK_GT(batch.front().timestamp.count(), 0);
+    for (const auto& order : batch) {
+        BOOST_CHECK(order.timestamp == batch.front().timestamp);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()